@@ -1928,6 +1928,16 @@ static const BYTE rewind_fetch_tab[] = {
 #endif
 #endif
 
+#ifndef DRIVE_CPU
+        if (monitor_cputrace_enabled) {
+            if (p0 == 0x20) {
+                monitor_cputrace_store(reg_pc, p0, p1, LOAD(reg_pc+2), reg_a_read, reg_x, reg_y, reg_sp, LOCAL_STATUS());
+            } else {
+                monitor_cputrace_store(reg_pc, p0, p1, p2 >> 8, reg_a_read, reg_x, reg_y, reg_sp, LOCAL_STATUS());
+            }
+        }
+#endif
+
 #ifdef DEBUG
 #ifdef DRIVE_CPU
         if (TRACEFLG) {
@@ -1436,6 +1436,14 @@ static const BYTE fetch_tab[] = {
         memmap_state &= ~(MEMMAP_STATE_INSTR | MEMMAP_STATE_OPCODE);
 #endif
 
+        if (monitor_cputrace_enabled) {
+            if (p0 == 0x20) {
+                monitor_cputrace_store(reg_pc, p0, p1, LOAD(reg_pc+2), reg_a_read, reg_x, reg_y, reg_sp, LOCAL_STATUS());
+            } else {
+                monitor_cputrace_store(reg_pc, p0, p1, p2 >> 8, reg_a_read, reg_x, reg_y, reg_sp, LOCAL_STATUS());
+            }
+        }
+
 #ifdef DEBUG
         if (TRACEFLG) {
             BYTE op = (BYTE)(p0);
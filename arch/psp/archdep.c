@@ -221,6 +221,19 @@ char *archdep_default_fliplist_file_name(void)
     }
 }
 
+/* Return a malloc'ed path for the file `name' in the user directory.  */
+char *archdep_pref_file_name(const char *name)
+{
+    if (archdep_pref_path == NULL) {
+        const char *home;
+
+        home = archdep_home_path();
+        return util_concat(home, "/.vice/", name, NULL);
+    } else {
+        return util_concat(archdep_pref_path, "/", name, NULL);
+    }
+}
+
 char *archdep_default_save_resource_file_name(void)
 { 
     char *fname;
@@ -515,6 +528,18 @@ int archdep_stat(const char *file_name, unsigned int *len, unsigned int *isdir)
     return 0;
 }
 
+int archdep_file_mtime(const char *file_name, unsigned long *mtime)
+{
+    struct stat statbuf;
+
+    if (stat(file_name, &statbuf) < 0)
+        return -1;
+
+    *mtime = (unsigned long)statbuf.st_mtime;
+
+    return 0;
+}
+
 int archdep_file_is_blockdev(const char *name)
 {
     struct stat buf;
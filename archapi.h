@@ -47,6 +47,7 @@ extern char *archdep_make_backup_filename(const char *fname);
 extern int archdep_mkdir(const char *pathname, int mode);
 extern int archdep_stat(const char *file_name, unsigned int *len,
                         unsigned int *isdir);
+extern int archdep_file_mtime(const char *file_name, unsigned long *mtime);
 
 /* Resource handling.  */
 extern char *archdep_default_resource_file_name(void);
@@ -55,6 +56,9 @@ extern char *archdep_default_save_resource_file_name(void);
 /* Fliplist.  */
 extern char *archdep_default_fliplist_file_name(void);
 
+/* Files kept in the user directory (TAP indexes, caches).  */
+extern char *archdep_pref_file_name(const char *name);
+
 /* Autostart-PRG */
 extern char *archdep_default_autostart_disk_image_file_name(void);
 
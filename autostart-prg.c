@@ -37,6 +37,7 @@
 #include "util.h"
 
 #include "diskimage.h"
+#include "t64.h"
 #include "vdrive.h"
 #include "vdrive-iec.h"
 #include "vdrive-internal.h"
@@ -269,6 +270,116 @@ int autostart_prg_with_disk_image(const char *file_name,
     return 0;
 }
 
+/* Replace the program to inject with `size' bytes of `data' that load at
+   `start_addr'.  */
+static int set_inject_prg(WORD start_addr, const BYTE *data, int size,
+                          const char *file_name, log_t log)
+{
+    if (size <= 0 || (int)start_addr + size - 1 > 0xffff) {
+        log_error(log, "Invalid size of '%s': %d", file_name, size);
+        return -1;
+    }
+
+    if (inject_prg != NULL) {
+        free_prg(inject_prg);
+    }
+
+    inject_prg = lib_malloc(sizeof(autostart_prg_t));
+    inject_prg->data = lib_malloc(size);
+    memcpy(inject_prg->data, data, size);
+    inject_prg->start_addr = start_addr;
+    inject_prg->size = (WORD)size;
+
+    return 0;
+}
+
+int autostart_prg_from_disk_image(const char *file_name, log_t log)
+{
+    const unsigned int drive = 8;
+    const unsigned int secondary = 0;
+    vdrive_t *vdrive;
+    BYTE *buf;
+    int len, status, result;
+
+    vdrive = file_system_get_vdrive(drive);
+    if (vdrive == NULL || vdrive->image == NULL) {
+        return -1;
+    }
+
+    /* open the first file on disk just like `LOAD"*",8,1' does */
+    if (vdrive_iec_open(vdrive, (const BYTE *)"*", 1, secondary,
+        NULL) != SERIAL_OK) {
+        log_error(log, "Could not open the first file of '%s'", file_name);
+        return -1;
+    }
+
+    /* the last byte comes with SERIAL_EOF */
+    buf = lib_malloc(0x10000 + 2);
+    len = 0;
+    do {
+        status = vdrive_iec_read(vdrive, &buf[len], secondary);
+        if (status != SERIAL_OK && status != SERIAL_EOF) {
+            break;
+        }
+        len++;
+    } while (status == SERIAL_OK && len < 0x10000 + 2);
+
+    vdrive_iec_close(vdrive, secondary);
+
+    if (status != SERIAL_EOF || len < 3) {
+        log_error(log, "Could not read the first file of '%s'", file_name);
+        lib_free(buf);
+        return -1;
+    }
+
+    result = set_inject_prg((WORD)(buf[0] | (buf[1] << 8)), buf + 2, len - 2,
+                            file_name, log);
+    lib_free(buf);
+
+    return result;
+}
+
+int autostart_prg_from_t64(const char *file_name, log_t log)
+{
+    t64_t *t64;
+    t64_file_record_t *rec;
+    unsigned int read_only;
+    BYTE *buf;
+    int size, result;
+
+    t64 = t64_open(file_name, &read_only);
+    if (t64 == NULL) {
+        return -1;
+    }
+
+    if (t64_seek_to_next_file(t64, 0) < 0
+        || (rec = t64_get_current_file_record(t64)) == NULL) {
+        log_error(log, "No file found in '%s'", file_name);
+        t64_close(t64);
+        return -1;
+    }
+
+    size = t64_file_record_get_size(rec);
+    if (size <= 0) {
+        log_error(log, "Invalid size of '%s': %d", file_name, size);
+        t64_close(t64);
+        return -1;
+    }
+
+    buf = lib_malloc(size);
+    if (t64_read(t64, buf, size) != size) {
+        log_error(log, "Error loading data from '%s'", file_name);
+        result = -1;
+    } else {
+        result = set_inject_prg(rec->start_addr, buf, size, file_name, log);
+    }
+
+    lib_free(buf);
+    t64_close(t64);
+
+    return result;
+}
+
 int autostart_prg_perform_injection(log_t log)
 {
     int i;
@@ -54,6 +54,11 @@ extern int autostart_prg_with_disk_image(const char *file_name,
                                          fileio_info_t *fh, log_t log,
                                          const char *image_name);
 
+/* Prepare the injection of the first file of the disk image attached to
+   unit #8 or of the T64 image `file_name'.  */
+extern int autostart_prg_from_disk_image(const char *file_name, log_t log);
+extern int autostart_prg_from_t64(const char *file_name, log_t log);
+
 extern int autostart_prg_perform_injection(log_t log);
 
 #endif
@@ -48,6 +48,7 @@
 #include "tapecontents.h"
 #include "diskcontents.h"
 #include "interrupt.h"
+#include "ioutil.h"
 #include "kbdbuf.h"
 #include "lib.h"
 #include "log.h"
@@ -58,6 +59,7 @@
 #include "network.h"
 #include "resources.h"
 #include "snapshot.h"
+#include "tap.h"
 #include "tape.h"
 #include "translate.h"
 #include "types.h"
@@ -132,6 +134,18 @@ static int autostart_wait_for_reset;
 /* Flag: load stage after LOADING enters ROM area */
 static int entered_rom = 0;
 
+/* Flag: the machine already sits at the BASIC prompt, so the commands are
+   typed right away instead of resetting the machine first.  */
+static int autostart_at_ready = 0;
+
+/* Snapshot of the machine at the first READY prompt, restored by the
+   direct injection path instead of booting again.  */
+static char *boot_state_name = NULL;
+
+/* Flag: the boot state is being saved (1), is available (2) or cannot be
+   saved (-1).  */
+static int boot_state = 0;
+
 /* ------------------------------------------------------------------------- */
 
 static int AutostartRunWithColon = 0;
@@ -144,6 +158,8 @@ static int AutostartPrgMode = AUTOSTART_PRG_MODE_VFS;
 
 static char *AutostartPrgDiskImage = NULL;
 
+static int AutostartBootState = 0;
+
 static const char * const AutostartRunCommandsAvailable[] = { "RUN\r", "RUN:\r" };
 
 static const char * AutostartRunCommand = NULL;
@@ -216,6 +232,15 @@ static int set_autostart_prg_mode(int val, void *param)
     return 0;
 }
 
+/*! \internal \brief set if autostart should inject programs into a
+    restored boot state */
+static int set_autostart_boot_state(int val, void *param)
+{
+    AutostartBootState = val ? 1 : 0;
+
+    return 0;
+}
+
 /*! \internal \brief set disk image name of autostart prg mode */
 
 static int set_autostart_prg_disk_image(const char *val, void *param)
@@ -243,6 +268,8 @@ static const resource_int_t resources_int[] = {
       &AutostartWarp, set_autostart_warp, NULL },
     { "AutostartPrgMode", 0, RES_EVENT_NO, (resource_value_t)0,
       &AutostartPrgMode, set_autostart_prg_mode, NULL },
+    { "AutostartBootState", 0, RES_EVENT_NO, (resource_value_t)0,
+      &AutostartBootState, set_autostart_boot_state, NULL },
     { NULL }
 };
 
@@ -313,6 +340,16 @@ static const cmdline_option_t cmdline_options[] =
       USE_PARAM_ID, USE_DESCRIPTION_ID,
       IDCLS_UNUSED, IDCLS_SET_DISK_IMAGE_FOR_AUTOSTART_PRG,
       NULL, NULL },
+    { "-autostart-boot-state", SET_RESOURCE, 0,
+      NULL, NULL, "AutostartBootState", (resource_value_t)1,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      NULL, T_("Keep the machine state at the first READY prompt and inject later programs into it without booting") },
+    { "+autostart-boot-state", SET_RESOURCE, 0,
+      NULL, NULL, "AutostartBootState", (resource_value_t)0,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      NULL, T_("Always boot the machine before autostarting") },
     { NULL }
 };
 
@@ -460,6 +497,46 @@ static void load_snapshot_trap(WORD unused_addr, void *unused_data)
     ui_update_menus();
 }
 
+static void save_boot_state_trap(WORD unused_addr, void *unused_data)
+{
+    boot_state_name = archdep_tmpnam();
+
+    if (machine_write_snapshot(boot_state_name, 0, 0, 0) < 0) {
+        log_error(autostart_log, "Cannot save the boot state to `%s'.",
+                  boot_state_name);
+        ioutil_remove(boot_state_name);
+        lib_free(boot_state_name);
+        boot_state_name = NULL;
+        boot_state = -1;
+        return;
+    }
+
+    log_message(autostart_log, "Saved the boot state.");
+    boot_state = 2;
+}
+
+/* `data' is the boot state to restore first, or NULL.  */
+static void direct_injection_trap(WORD unused_addr, void *data)
+{
+    if (data != NULL && machine_read_snapshot((const char *)data, 0) < 0) {
+        log_error(autostart_log, "Cannot restore the boot state.");
+        disable_warp_if_was_requested();
+        autostartmode = AUTOSTART_ERROR;
+        return;
+    }
+
+    if (autostart_prg_perform_injection(autostart_log) < 0) {
+        disable_warp_if_was_requested();
+        autostartmode = AUTOSTART_ERROR;
+        return;
+    }
+
+    /* wait for ready cursor and type RUN */
+    autostartmode = AUTOSTART_WAITLOADREADY;
+    autostart_wait_for_reset = 0;
+    ui_update_menus();
+}
+
 /* ------------------------------------------------------------------------- */
 
 /* Reset autostart.  */
@@ -814,6 +891,29 @@ void autostart_advance(void)
     if (autostart_wait_for_reset)
         return;
 
+    /* Save the machine at the READY prompt of the first boot, before
+       anything is typed or injected.  */
+    if (AutostartBootState && boot_state == 0
+        && (autostartmode == AUTOSTART_HASDISK
+        || autostartmode == AUTOSTART_HASTAPE
+        || autostartmode == AUTOSTART_INJECT)) {
+        switch (check("READY.", AUTOSTART_WAIT_BLINK)) {
+          case YES:
+            boot_state = 1;
+            interrupt_maincpu_trigger_trap(save_boot_state_trap, NULL);
+            return;
+          case NOT_YET:
+            if (autostartmode == AUTOSTART_INJECT)
+                return;
+            break;
+          case NO:
+            break;
+        }
+    }
+
+    if (boot_state == 1)
+        return;
+
     switch (autostartmode) {
       case AUTOSTART_HASTAPE:
         advance_hastape();
@@ -862,24 +962,30 @@ static void reboot_for_autostart(const char *program_name, unsigned int mode,
     if (!autostart_enabled)
         return;
 
-    log_message(autostart_log, "Resetting the machine to autostart '%s'",
-                program_name ? program_name : "*");
-    
-    mem_powerup();
-    
-    autostart_ignore_reset = 1;
+    if (autostart_at_ready) {
+        log_message(autostart_log, "Autostarting '%s' from the BASIC prompt",
+                    program_name ? program_name : "*");
+    } else {
+        log_message(autostart_log, "Resetting the machine to autostart '%s'",
+                    program_name ? program_name : "*");
+
+        mem_powerup();
+
+        autostart_ignore_reset = 1;
+    }
     deallocate_program_name();
     if (program_name && program_name[0]) {
         autostart_program_name = lib_stralloc(program_name);
     }
     
-    machine_trigger_reset(MACHINE_RESET_MODE_SOFT);
+    if (!autostart_at_ready)
+        machine_trigger_reset(MACHINE_RESET_MODE_SOFT);
     
     /* The autostartmode must be set AFTER the shutdown to make the autostart
        threadsafe for OS/2 */
     autostartmode = mode;
     autostart_run_mode = runmode;
-    autostart_wait_for_reset = 1;
+    autostart_wait_for_reset = !autostart_at_ready;
     
     /* enable warp before reset */
     if (mode != AUTOSTART_HASSNAPSHOT) {
@@ -1078,6 +1184,72 @@ int autostart_prg(const char *file_name, unsigned int runmode)
     return result;
 }
 
+/* Inject the first program of `file_name' into the saved boot state, or
+   straight into RAM if the machine already sits at the READY prompt.
+   Returns -1 if the program cannot be extracted; the caller then falls
+   back to booting.  */
+static int autostart_direct(const char *file_name, unsigned int runmode)
+{
+    BYTE vmajor, vminor;
+    snapshot_t *snap;
+    tap_t *tap;
+    unsigned int read_only = 1;
+    fileio_info_t *finfo;
+    int result = -1;
+
+    if (file_system_attach_disk(8, file_name) >= 0) {
+        result = autostart_prg_from_disk_image(file_name, autostart_log);
+        if (result >= 0)
+            log_message(autostart_log,
+                        "Attached file `%s' as a disk image.", file_name);
+    } else if (machine_class != VICE_MACHINE_C64DTV
+               && autostart_prg_from_t64(file_name, autostart_log) >= 0) {
+        result = 0;
+        if (tape_image_attach(1, file_name) >= 0)
+            log_message(autostart_log,
+                        "Attached file `%s' as a tape image.", file_name);
+    } else if (machine_class != VICE_MACHINE_C64DTV
+               && (tap = tap_open(file_name, &read_only)) != NULL) {
+        /* TAP images are loaded by booting, they would pass as raw PRG */
+        tap_close(tap);
+    } else if ((snap = snapshot_open(file_name, &vmajor, &vminor,
+                                     machine_name)) != NULL) {
+        snapshot_close(snap);
+    } else {
+        finfo = fileio_open(file_name, NULL,
+                            FILEIO_FORMAT_RAW | FILEIO_FORMAT_P00,
+                            FILEIO_COMMAND_READ | FILEIO_COMMAND_FSNAME,
+                            FILEIO_TYPE_PRG);
+        if (finfo != NULL) {
+            result = autostart_prg_with_ram_injection(file_name, finfo,
+                                                      autostart_log);
+            /* keep later loads working from the program's directory */
+            if (result >= 0 && AutostartPrgMode == AUTOSTART_PRG_MODE_VFS)
+                autostart_prg_with_virtual_fs(file_name, finfo,
+                                              autostart_log);
+            fileio_close(finfo);
+        }
+    }
+
+    if (result < 0)
+        return -1;
+
+    log_message(autostart_log, "Injecting the first program of `%s' %s.",
+                file_name, autostart_at_ready ? "at the READY prompt"
+                : "into the boot state");
+
+    deallocate_program_name();
+    autostart_run_mode = runmode;
+    autostartmode = AUTOSTART_INJECT;
+    autostart_wait_for_reset = 1;
+    enable_warp_if_requested();
+
+    interrupt_maincpu_trigger_trap(direct_injection_trap,
+                                   autostart_at_ready ? NULL : boot_state_name);
+
+    return 0;
+}
+
 /* ------------------------------------------------------------------------- */
 
 /* Autostart `file_name', trying to auto-detect its type.  */
@@ -1095,6 +1267,11 @@ int autostart_autodetect(const char *file_name, const char *program_name,
 
     log_message(autostart_log, "Autodetecting image type of `%s'.", file_name);
 
+    if (AutostartBootState && (boot_state == 2 || autostart_at_ready)
+        && program_name == NULL && program_number <= 1
+        && autostart_direct(file_name, runmode) == 0)
+        return 0;
+
     if (autostart_disk(file_name, program_name, program_number, runmode) == 0) {
         log_message(autostart_log, "`%s' recognized as disk image.", file_name);
         return 0;
@@ -1140,6 +1317,23 @@ int autostart_device(int num)
     return -1;
 }
 
+/* Return nonzero if the machine has booted and sits at the BASIC prompt.  */
+int autostart_basic_ready(void)
+{
+    if (!autostart_enabled || maincpu_clk < min_cycles)
+        return 0;
+
+    return check("READY.", AUTOSTART_WAIT_BLINK) == YES;
+}
+
+/* If `on' is nonzero, the following autostarts assume the machine is at
+   the BASIC prompt (e.g. restored from a snapshot taken there) and skip
+   the reset.  */
+void autostart_set_at_ready(int on)
+{
+    autostart_at_ready = on;
+}
+
 /* Disable autostart on reset.  */
 void autostart_reset(void)
 {
@@ -1168,5 +1362,11 @@ void autostart_shutdown(void)
     deallocate_program_name();
 
     autostart_prg_shutdown();
+
+    if (boot_state_name != NULL) {
+        ioutil_remove(boot_state_name);
+        lib_free(boot_state_name);
+        boot_state_name = NULL;
+    }
 }
 
@@ -61,6 +61,8 @@ extern void autostart_advance(void);
 
 extern int autostart_device(int num);
 extern void autostart_reset(void);
+extern int autostart_basic_ready(void);
+extern void autostart_set_at_ready(int on);
 
 extern int autostart_ignore_reset;
 
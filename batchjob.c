@@ -0,0 +1,300 @@
+/*
+ * batchjob.c - Run a list of test jobs from one booted machine.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* With `-jobfile', the emulator boots once, saves a snapshot as soon as
+   the KERNAL sits at the READY prompt and then runs every job of the file
+   in turn: the snapshot is restored, the job's image is autostarted from
+   the prompt without a reset and the machine runs in warp mode for the
+   job's number of frames.  The job file has one job per line:
+
+     <image> [<frames>]
+
+   Empty lines and lines starting with `#' are ignored; jobs without a
+   frame count use `-jobframes'.  The emulator exits after the last job.  */
+
+#include "vice.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "attach.h"
+#include "autostart.h"
+#include "batchjob.h"
+#include "cmdline.h"
+#include "interrupt.h"
+#include "ioutil.h"
+#include "lib.h"
+#include "log.h"
+#include "machine-video.h"
+#include "machine.h"
+#include "resources.h"
+#include "screenshot.h"
+#include "tape.h"
+#include "translate.h"
+#include "types.h"
+#include "util.h"
+
+
+struct batchjob_s {
+    char *image;
+    unsigned int frames;
+};
+typedef struct batchjob_s batchjob_t;
+
+static enum {
+    BATCHJOB_NONE,
+    BATCHJOB_BOOTING,
+    BATCHJOB_RUNNING,
+    BATCHJOB_TRAP_PENDING
+} batchjob_state = BATCHJOB_NONE;
+
+static char *job_file_name = NULL;
+static char *job_screenshot_name = NULL;
+static unsigned int job_default_frames = 500;
+
+static batchjob_t *jobs = NULL;
+static unsigned int num_jobs = 0;
+static unsigned int current_job = 0;
+static unsigned int job_frames = 0;
+
+static char *boot_snapshot_name = NULL;
+
+static log_t batchjob_log = LOG_ERR;
+
+
+static int cmdline_job_file(const char *param, void *extra_param)
+{
+    util_string_set(&job_file_name, param);
+    batchjob_state = BATCHJOB_BOOTING;
+    return 0;
+}
+
+static int cmdline_job_frames(const char *param, void *extra_param)
+{
+    int frames = atoi(param);
+
+    if (frames < 1)
+        return -1;
+
+    job_default_frames = (unsigned int)frames;
+    return 0;
+}
+
+static int cmdline_job_screenshot(const char *param, void *extra_param)
+{
+    util_string_set(&job_screenshot_name, param);
+    return 0;
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-jobfile", CALL_FUNCTION, 1,
+      cmdline_job_file, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<name>"), T_("Boot once and run each image listed in the file from the READY prompt, then exit") },
+    { "-jobframes", CALL_FUNCTION, 1,
+      cmdline_job_frames, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<frames>"), T_("Number of frames each job runs unless the job file says otherwise (default 500)") },
+    { "-jobscreenshot", CALL_FUNCTION, 1,
+      cmdline_job_screenshot, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<basename>"), T_("Save the screen at the end of each job to <basename>-NNN.bmp") },
+    { NULL }
+};
+
+int batchjob_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+void batchjob_shutdown(void)
+{
+    unsigned int i;
+
+    if (boot_snapshot_name != NULL) {
+        ioutil_remove(boot_snapshot_name);
+        lib_free(boot_snapshot_name);
+        boot_snapshot_name = NULL;
+    }
+
+    for (i = 0; i < num_jobs; i++)
+        lib_free(jobs[i].image);
+
+    lib_free(jobs);
+    jobs = NULL;
+    num_jobs = 0;
+
+    lib_free(job_file_name);
+    job_file_name = NULL;
+    lib_free(job_screenshot_name);
+    job_screenshot_name = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int batchjob_read_file(void)
+{
+    FILE *fd;
+    char line[1024];
+    char *p, *last;
+    unsigned int frames;
+
+    fd = fopen(job_file_name, MODE_READ_TEXT);
+    if (fd == NULL) {
+        log_error(batchjob_log, "Cannot open job file `%s'.", job_file_name);
+        return -1;
+    }
+
+    while (util_get_line(line, sizeof(line), fd) >= 0) {
+        p = line;
+        while (isspace((unsigned char)*p))
+            p++;
+
+        if (*p == '\0' || *p == '#')
+            continue;
+
+        /* A trailing number is the frame count of the job.  */
+        frames = job_default_frames;
+        last = p + strlen(p);
+        while (last > p && !isspace((unsigned char)last[-1]))
+            last--;
+        if (last > p && *last != '\0'
+            && strspn(last, "0123456789") == strlen(last)) {
+            frames = (unsigned int)atoi(last);
+            while (last > p && isspace((unsigned char)last[-1]))
+                last--;
+            *last = '\0';
+        }
+
+        jobs = lib_realloc(jobs, (num_jobs + 1) * sizeof(batchjob_t));
+        jobs[num_jobs].image = lib_stralloc(p);
+        jobs[num_jobs].frames = frames > 0 ? frames : job_default_frames;
+        num_jobs++;
+    }
+
+    fclose(fd);
+
+    return 0;
+}
+
+static void batchjob_start_job(void)
+{
+    batchjob_t *job = &jobs[current_job];
+
+    if (machine_read_snapshot(boot_snapshot_name, 0) < 0) {
+        log_error(batchjob_log, "Cannot restore the boot snapshot.");
+        exit(1);
+    }
+
+    file_system_detach_disk(-1);
+    tape_image_detach(1);
+
+    log_message(batchjob_log, "Job %u/%u: `%s', %u frames.", current_job + 1,
+                num_jobs, job->image, job->frames);
+
+    autostart_set_at_ready(1);
+    if (autostart_autodetect(job->image, NULL, 0, AUTOSTART_MODE_RUN) < 0)
+        log_error(batchjob_log, "Job %u: cannot autostart `%s'.",
+                  current_job + 1, job->image);
+    autostart_set_at_ready(0);
+
+    job_frames = 0;
+    batchjob_state = BATCHJOB_RUNNING;
+}
+
+static void batchjob_boot_trap(WORD addr, void *data)
+{
+    boot_snapshot_name = archdep_tmpnam();
+
+    if (machine_write_snapshot(boot_snapshot_name, 0, 0, 0) < 0) {
+        log_error(batchjob_log, "Cannot write the boot snapshot `%s'.",
+                  boot_snapshot_name);
+        exit(1);
+    }
+
+    log_message(batchjob_log, "Machine booted, running %u job(s).",
+                num_jobs);
+
+    current_job = 0;
+    batchjob_start_job();
+}
+
+static void batchjob_end_trap(WORD addr, void *data)
+{
+    char *name;
+
+    if (job_screenshot_name != NULL) {
+        name = lib_msprintf("%s-%03u.bmp", job_screenshot_name,
+                            current_job + 1);
+        if (screenshot_save("BMP", name, machine_video_canvas_get(0)) < 0)
+            log_error(batchjob_log, "Cannot save screenshot `%s'.", name);
+        lib_free(name);
+    }
+
+    log_message(batchjob_log, "Job %u: done.", current_job + 1);
+
+    current_job++;
+    if (current_job >= num_jobs) {
+        log_message(batchjob_log, "Ran %u job(s).", num_jobs);
+        exit(0);
+    }
+
+    batchjob_start_job();
+}
+
+void batchjob_frame(void)
+{
+    switch (batchjob_state) {
+      case BATCHJOB_BOOTING:
+        if (batchjob_log == LOG_ERR) {
+            batchjob_log = log_open("Batch Job");
+
+            if (batchjob_read_file() < 0 || num_jobs == 0) {
+                log_error(batchjob_log, "No jobs to run.");
+                exit(1);
+            }
+
+            resources_set_int("WarpMode", 1);
+        }
+        if (autostart_basic_ready()) {
+            batchjob_state = BATCHJOB_TRAP_PENDING;
+            interrupt_maincpu_trigger_trap(batchjob_boot_trap, NULL);
+        }
+        break;
+      case BATCHJOB_RUNNING:
+        if (++job_frames >= jobs[current_job].frames) {
+            batchjob_state = BATCHJOB_TRAP_PENDING;
+            interrupt_maincpu_trigger_trap(batchjob_end_trap, NULL);
+        }
+        break;
+      default:
+        break;
+    }
+}
@@ -118,6 +118,7 @@ static int format_cmd(int nargs, char **args);
 static int help_cmd(int nargs, char **args);
 static int info_cmd(int nargs, char **args);
 static int list_cmd(int nargs, char **args);
+static int manifest_cmd(int nargs, char **args);
 static int name_cmd(int nargs, char **args);
 static int p00save_cmd(int nargs, char **args);
 static int quit_cmd(int nargs, char **args);
@@ -280,6 +281,18 @@ const command_t command_list[] = {
       "List files matching <pattern> (default is all files).",
       0, 1,
       list_cmd },
+    { "manifest",
+      "manifest <file> [<jobs> <job>]",
+      "Run the operations listed in <file>, one per line, in the form\n"
+      "`<diskimage> <command> [<args>]'.  Each image is attached to unit 8\n"
+      "while its operations run, and is kept attached as long as consecutive\n"
+      "lines name it.  Failing lines are reported and skipped.  `attach',\n"
+      "`unit', `quit' and `format' with an image name are not allowed.\n"
+      "With <jobs> and <job>, only the images assigned to job number <job>\n"
+      "(0 based) of <jobs> are handled, so a manifest can be split across\n"
+      "several c1541 processes.  All lines naming the same image (spelled\n"
+      "the same way) go to the same job and run in their order.",
+      1, 3, manifest_cmd },
     { "name",
       "name <diskname>[,<id>] <unit>",
       "Change image name.",
@@ -388,7 +401,14 @@ static int split_args(const char *line, int *nargs, char **args)
               in_quote = !in_quote;
               continue;
           case '\\':
+              /* A backslash at the end of the line escapes nothing.  */
+              if (*(s + 1) == 0)
+                  continue;
               begin_of_arg = 0;
+              if (d - tmp >= (int)sizeof(tmp) - 1) {
+                  fprintf(stderr, "Argument too long.\n");
+                  return -1;
+              }
               *(d++) = *(++s);
               continue;
           case ' ':
@@ -426,6 +446,10 @@ static int split_args(const char *line, int *nargs, char **args)
               }
           default:
               begin_of_arg = 0;
+              if (d - tmp >= (int)sizeof(tmp) - 1) {
+                  fprintf(stderr, "Argument too long.\n");
+                  return -1;
+              }
               *(d++) = *s;
         }
     }
@@ -1359,6 +1383,142 @@ static int list_cmd(int nargs, char **args)
     return FD_OK;
 }
 
+/* Return the job of `jobs' handling image `name'.  Whole images are
+   assigned to a job, so parallel c1541 processes never open the same
+   image.  */
+static int manifest_image_job(const char *name, int jobs)
+{
+    DWORD hash = 2166136261U;
+
+    while (*name != '\0') {
+        hash ^= (BYTE)*name++;
+        hash *= 16777619U;
+    }
+
+    return (int)(hash % (DWORD)jobs);
+}
+
+/* Return nonzero if the command would change the attached image or the
+   current unit behind the manifest's back.  */
+static int manifest_command_forbidden(int match, int nargs)
+{
+    int (*func)(int, char **) = command_list[match].func;
+
+    return func == manifest_cmd || func == attach_cmd || func == unit_cmd
+           || func == quit_cmd || (func == format_cmd && nargs >= 4);
+}
+
+static int manifest_cmd(int nargs, char **args)
+{
+    FILE *fd;
+    char line[1024];
+    char *margs[MAXARG];
+    char *image_name = NULL;
+    vdrive_t *vdrive, *saved_vdrive;
+    int saved_drive_number;
+    int margc, match, i;
+    int jobs = 1, job = 0;
+    unsigned int lineno = 0, ops = 0, failed = 0;
+
+    /* manifest <file> [<jobs> <job>] */
+    if (nargs == 3)
+        return FD_BADVAL;
+
+    if (nargs == 4) {
+        if (arg_to_int(args[2], &jobs) < 0 || arg_to_int(args[3], &job) < 0
+            || jobs < 1 || job < 0 || job >= jobs)
+            return FD_BADVAL;
+    }
+
+    fd = fopen(args[1], MODE_READ_TEXT);
+    if (fd == NULL)
+        return FD_NOTRD;
+
+    for (i = 0; i < MAXARG; i++)
+        margs[i] = NULL;
+
+    /* The operations run on a private unit 8 drive, so the images attached
+       interactively are left alone.  */
+    vdrive = lib_calloc(1, sizeof(vdrive_t));
+    saved_vdrive = drives[0];
+    saved_drive_number = drive_number;
+    drives[0] = vdrive;
+    drive_number = 0;
+
+    while (fgets(line, sizeof(line), fd) != NULL) {
+        lineno++;
+
+        if (split_args(line, &margc, margs) < 0) {
+            fprintf(stderr, "%s:%u: Invalid line.\n", args[1], lineno);
+            failed++;
+            continue;
+        }
+
+        if (margc == 0 || margs[0][0] == '#')
+            continue;
+
+        if (manifest_image_job(margs[0], jobs) != job)
+            continue;
+
+        ops++;
+
+        if (margc < 2) {
+            fprintf(stderr, "%s:%u: Missing command.\n", args[1], lineno);
+            failed++;
+            continue;
+        }
+
+        match = lookup_command(margs[1]);
+        if (LOOKUP_SUCCESSFUL(match)
+            && manifest_command_forbidden(match, margc - 1)) {
+            fprintf(stderr, "%s:%u: `%s' is not allowed in a manifest.\n",
+                    args[1], lineno, margs[1]);
+            failed++;
+            continue;
+        }
+
+        if (image_name == NULL || strcmp(image_name, margs[0]) != 0) {
+            close_disk_image(vdrive, 8);
+            lib_free(image_name);
+            image_name = NULL;
+
+            if (open_disk_image(vdrive, margs[0], 8) < 0) {
+                fprintf(stderr, "%s:%u: Cannot attach `%s'.\n", args[1],
+                        lineno, margs[0]);
+                failed++;
+                continue;
+            }
+            image_name = lib_stralloc(margs[0]);
+            printf("%s:\n", image_name);
+        }
+
+        drive_number = 0;
+        if (lookup_and_execute_command(margc - 1, margs + 1) < 0) {
+            fprintf(stderr, "%s:%u: `%s' failed.\n", args[1], lineno,
+                    margs[1]);
+            failed++;
+        }
+    }
+
+    fclose(fd);
+
+    close_disk_image(vdrive, 8);
+    lib_free(image_name);
+    lib_free(vdrive);
+
+    for (i = 0; i < MAXARG; i++)
+        lib_free(margs[i]);
+
+    drives[0] = saved_vdrive;
+    drive_number = saved_drive_number;
+
+    printf("%u operations, %u failed.\n", ops, failed);
+
+    /* The failures have been reported already; FD_EXIT just makes a
+       non-interactive c1541 stop with an error code.  */
+    return failed ? FD_EXIT : FD_OK;
+}
+
 static int name_cmd(int nargs, char **args)
 {
     char *id;
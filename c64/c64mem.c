@@ -52,6 +52,7 @@
 #include "mem.h"
 #include "mmc64.h"
 #include "monitor.h"
+#include "monitor_cputrace.h"
 #include "plus256k.h"
 #include "plus60k.h"
 #include "ram.h"
@@ -183,9 +184,15 @@ static void check_data_set_alarm(void)
     }
 }
 
+static int mem_get_config(void)
+{
+    return mem_config;
+}
+
 void c64_mem_init(void)
 {
     clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
+    monitor_cputrace_set_bank_func(mem_get_config);
 }
 
 void mem_pla_config_changed(void)
@@ -41,6 +41,7 @@
 #include "translate.h"
 #include "types.h"
 #include "uiapi.h"
+#include "util.h"
 #include "vsidui.h"
 #include "vsync.h"
 #include "zfile.h"
@@ -107,6 +108,11 @@ static psid_t* psid = NULL;
 static int psid_tune = 0;
 static int keepenv = 0;
 
+/* Offline rendering of every subtune to `<basename>-NN.wav'.  */
+static char *render_basename = NULL;
+static int render_seconds = 180;
+static int render_tune = 0;
+
 static int set_keepenv(int val, void *param)
 {
     keepenv = val;
@@ -145,6 +151,21 @@ static int cmdline_psid_tune(const char *param, void *extra_param)
     return 0;
 }
 
+static int cmdline_render(const char *param, void *extra_param)
+{
+    util_string_set(&render_basename, param);
+    return 0;
+}
+
+static int cmdline_render_time(const char *param, void *extra_param)
+{
+    render_seconds = atoi(param);
+    if (render_seconds < 1) {
+        render_seconds = 1;
+    }
+    return 0;
+}
+
 static const cmdline_option_t cmdline_options[] =
 {
     /* The Video Standard options are copied from the machine files. */
@@ -178,6 +199,16 @@ static const cmdline_option_t cmdline_options[] =
       USE_PARAM_ID, USE_DESCRIPTION_ID,
       IDCLS_P_NUMBER, IDCLS_SPECIFY_PSID_TUNE_NUMBER,
       NULL, NULL },
+    { "-render", CALL_FUNCTION, 1,
+      cmdline_render, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<basename>"), T_("Render all tunes to <basename>-NN.wav in warp mode and exit") },
+    { "-rendertime", CALL_FUNCTION, 1,
+      cmdline_render_time, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<seconds>"), T_("Length of each rendered tune (default 180)") },
     { NULL }
 };
 
@@ -381,9 +412,47 @@ static int psid_set_cbm80(WORD vec, WORD addr)
     return i;
 }
 
+/* Point the WAV recording device at the file for the current tune.
+   Changing the argument makes the sound code reopen the device, which
+   finalizes the previous file.  */
+static void psid_render_set_file(void)
+{
+    char *name;
+
+    name = lib_msprintf("%s-%02d.wav", render_basename, render_tune);
+    resources_set_string("SoundRecordDeviceArg", name);
+    log_message(vlog, "Rendering tune %d to `%s'.", render_tune, name);
+    lib_free(name);
+}
+
+/* Start rendering: no realtime playback, samples only go to the
+   recording device, and warp mode runs the machine as fast as possible.  */
+static void psid_render_start(void)
+{
+    render_tune = 1;
+    psid_tune = render_tune;
+
+    resources_set_string("SoundDeviceName", "dummy");
+    resources_set_string("SoundRecordDeviceName", "wav");
+    psid_render_set_file();
+    resources_set_int("WarpMode", 1);
+}
+
+static void psid_render_next(void)
+{
+    if (render_tune >= psid->songs) {
+        log_message(vlog, "Rendered %d tune(s).", render_tune);
+        exit(0);
+    }
+
+    render_tune++;
+    psid_render_set_file();
+    psid_ui_set_tune(render_tune, NULL);
+}
+
 void psid_init_tune(void)
 {
-    int start_song = psid_tune;
+    int start_song;
     int sync, sid_model;
     int i;
     WORD reloc_addr;
@@ -397,6 +466,11 @@ void psid_init_tune(void)
         return;
     }
 
+    if (render_basename != NULL && render_tune == 0) {
+        psid_render_start();
+    }
+
+    start_song = psid_tune;
     psid->frames_played = 0;
 
     reloc_addr = psid->start_page << 8;
@@ -606,5 +680,10 @@ unsigned int psid_increment_frames(void)
 
     (psid->frames_played)++;
 
+    if (render_tune > 0 && psid->frames_played
+        >= (DWORD)(render_seconds * vsync_get_refresh_frequency())) {
+        psid_render_next();
+    }
+
     return (unsigned int)(psid->frames_played);
 }
@@ -334,6 +334,9 @@
 /* Enable MIDI emulation. */
 /* #define HAVE_MIDI */
 
+/* Can we use the minizip library to extract ZIP archives? */
+#define HAVE_MINIZIP 
+
 /* Define to 1 if you have the `mkstemp' function. */
 #define HAVE_MKSTEMP 1
 
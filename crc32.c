@@ -39,10 +39,12 @@
 static unsigned long crc32_table[256];
 static int crc32_is_initialized = 0;
 
-unsigned long crc32_buf(const char *buffer, unsigned int len)
+/* Continue the CRC `crc' of preceding data over `buffer'.  */
+unsigned long crc32_buf_update(unsigned long crc, const char *buffer,
+                               unsigned int len)
 {
     int i, j;
-    unsigned long crc, c;
+    unsigned long c;
     const char *p;
 
     if (!crc32_is_initialized) {
@@ -55,11 +57,16 @@ unsigned long crc32_buf(const char *buffer, unsigned int len)
         crc32_is_initialized = 1;
     }
 
-    crc = 0xffffffff;
+    crc = ~crc & 0xffffffff;
     for (p = buffer; len > 0; ++p, --len)
         crc = (crc >> 8) ^ crc32_table[(crc ^ *p) & 0xff];
     
-    return ~crc;
+    return ~crc & 0xffffffff;
+}
+
+unsigned long crc32_buf(const char *buffer, unsigned int len)
+{
+    return crc32_buf_update(0, buffer, len);
 }
 
 unsigned long crc32_file(const char *filename)
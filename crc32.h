@@ -29,6 +29,8 @@
 #define VICE_CRC32_H
 
 extern unsigned long crc32_buf(const char *buffer, unsigned int len);
+extern unsigned long crc32_buf_update(unsigned long crc, const char *buffer,
+                                      unsigned int len);
 extern unsigned long crc32_file(const char *filename);
 
 #endif
@@ -566,11 +566,21 @@ void datasette_set_tape_image(tap_t *image)
 
     if (image != NULL) {
         /* We need the length of tape for realistic counter. */
-        current_image->cycle_counter_total = 0;
-        do {
-            gap = datasette_read_gap(1);
-            current_image->cycle_counter_total += gap / 8;
-        } while (gap);
+        current_image->cycle_counter_total
+            = tap_get_cycle_counter_total(current_image,
+                                          datasette_zero_gap_delay,
+                                          datasette_speed_tuning);
+        if (current_image->cycle_counter_total < 0) {
+            current_image->cycle_counter_total = 0;
+            do {
+                gap = datasette_read_gap(1);
+                current_image->cycle_counter_total += gap / 8;
+            } while (gap);
+            tap_set_cycle_counter_total(current_image,
+                                        current_image->cycle_counter_total,
+                                        datasette_zero_gap_delay,
+                                        datasette_speed_tuning);
+        }
         current_image->current_file_seek_position = 0;
         last_tap = next_tap = 0;
         fullwave = 0;
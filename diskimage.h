@@ -67,6 +67,9 @@ struct disk_image_s {
     unsigned int type;
     unsigned int tracks;
     struct gcr_s *gcr;
+    /* Incremented on every write, so cached views of the contents can
+       tell when they are out of date.  */
+    unsigned int write_count;
 };
 typedef struct disk_image_s disk_image_t;
 
@@ -78,6 +81,8 @@ extern void disk_image_resources_shutdown(void);
 extern void disk_image_fsimage_name_set(disk_image_t *image, char *name);
 extern char *disk_image_fsimage_name_get(disk_image_t *image);
 extern void *disk_image_fsimage_fd_get(disk_image_t *image);
+extern const BYTE *disk_image_fsimage_memory_get(disk_image_t *image,
+                                                 unsigned int *size);
 extern int disk_image_fsimage_create(const char *name, unsigned int type);
 
 extern void disk_image_rawimage_name_set(disk_image_t *image, char *name);
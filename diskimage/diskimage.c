@@ -240,6 +240,15 @@ void *disk_image_fsimage_fd_get(disk_image_t *image)
     return fsimage_fd_get(image);
 }
 
+const BYTE *disk_image_fsimage_memory_get(disk_image_t *image,
+                                          unsigned int *size)
+{
+    if (image->device != DISK_IMAGE_DEVICE_FS)
+        return NULL;
+
+    return fsimage_memory_get(image, size);
+}
+
 int disk_image_fsimage_create(const char *name, unsigned int type)
 {
     return fsimage_create(name, type);
@@ -353,6 +362,8 @@ int disk_image_open(disk_image_t *image)
 {
     int rc = 0;
 
+    image->write_count = 0;
+
     switch (image->device) {
       case DISK_IMAGE_DEVICE_FS:
         rc = fsimage_open(image);
@@ -439,6 +450,8 @@ int disk_image_write_sector(disk_image_t *image, BYTE *buf, unsigned int track,
 {
     int rc = 0;
 
+    image->write_count++;
+
     switch (image->device) {
       case DISK_IMAGE_DEVICE_FS:
         rc = fsimage_write_sector(image, buf, track, sector);
@@ -473,6 +486,8 @@ int disk_image_write_track(disk_image_t *image, unsigned int track,
                            int gcr_track_size, BYTE *gcr_speed_zone,
                            BYTE *gcr_track_start_ptr)
 {
+    image->write_count++;
+
     return fsimage_gcr_write_track(image, track, gcr_track_size, gcr_speed_zone,
                                    gcr_track_start_ptr);
 }
@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "archdep.h"
 #include "cbmdos.h"
@@ -39,6 +40,7 @@
 #include "lib.h"
 #include "log.h"
 #include "types.h"
+#include "util.h"
 #include "x64.h"
 #include "zfile.h"
 
@@ -73,6 +75,22 @@ void *fsimage_fd_get(disk_image_t *image)
     return (void *)(fsimage->fd);
 }
 
+/* Return the in-memory copy of the image, NULL if it is not kept in
+   memory.  */
+const BYTE *fsimage_memory_get(disk_image_t *image, unsigned int *size)
+{
+    fsimage_t *fsimage;
+
+    fsimage = image->media.fsimage;
+
+    if (fsimage->cache == NULL)
+        return NULL;
+
+    *size = (unsigned int)fsimage->cache_size;
+
+    return fsimage->cache;
+}
+
 /*-----------------------------------------------------------------------*/
 
 void fsimage_error_info_create(fsimage_t *fsimage)
@@ -111,6 +129,73 @@ void fsimage_media_destroy(disk_image_t *image)
 
 /*-----------------------------------------------------------------------*/
 
+/* Sector based images are read into memory once when opened, so sector
+   reads do not need a seek and a read on the file every time.  Written
+   sectors update the copy and still go to the file right away.  */
+
+static int fsimage_cache_type(disk_image_t *image)
+{
+    switch (image->type) {
+      case DISK_IMAGE_TYPE_D64:
+      case DISK_IMAGE_TYPE_D67:
+      case DISK_IMAGE_TYPE_D71:
+      case DISK_IMAGE_TYPE_D81:
+      case DISK_IMAGE_TYPE_D80:
+      case DISK_IMAGE_TYPE_D82:
+      case DISK_IMAGE_TYPE_X64:
+        return 1;
+    }
+    return 0;
+}
+
+static void fsimage_cache_create(disk_image_t *image)
+{
+    fsimage_t *fsimage;
+    size_t size;
+
+    fsimage = image->media.fsimage;
+
+    if (!fsimage_cache_type(image))
+        return;
+
+    size = util_file_length(fsimage->fd);
+
+    fsimage->cache = lib_malloc(size);
+    fsimage->cache_size = size;
+
+    rewind(fsimage->fd);
+
+    if (fread(fsimage->cache, size, 1, fsimage->fd) < 1) {
+        log_warning(fsimage_log, "Cannot cache disk image `%s'.",
+                    fsimage->name);
+        lib_free(fsimage->cache);
+        fsimage->cache = NULL;
+        fsimage->cache_size = 0;
+    }
+}
+
+static void fsimage_cache_destroy(fsimage_t *fsimage)
+{
+    lib_free(fsimage->cache);
+    fsimage->cache = NULL;
+    fsimage->cache_size = 0;
+}
+
+/* Make room for a sector past the end of the image, used when a 1541 image
+   is extended to 40 tracks.  */
+static void fsimage_cache_extend(fsimage_t *fsimage, size_t size)
+{
+    size_t old_size;
+
+    old_size = fsimage->cache_size;
+
+    fsimage->cache = lib_realloc(fsimage->cache, size);
+    memset(fsimage->cache + old_size, 0, size - old_size);
+    fsimage->cache_size = size;
+}
+
+/*-----------------------------------------------------------------------*/
+
 int fsimage_open(disk_image_t *image)
 {
     fsimage_t *fsimage;
@@ -134,8 +219,10 @@ int fsimage_open(disk_image_t *image)
         return -1;
     }
 
-    if (fsimage_probe(image) == 0)
+    if (fsimage_probe(image) == 0) {
+        fsimage_cache_create(image);
         return 0;
+    }
 
     zfile_fclose(fsimage->fd);
     log_message(fsimage_log, "Unknown disk image `%s'.", fsimage->name);
@@ -153,6 +240,8 @@ int fsimage_close(disk_image_t *image)
         return -1;
     }
 
+    fsimage_cache_destroy(fsimage);
+
     zfile_fclose(fsimage->fd);
 
     fsimage_error_info_destroy(fsimage);
@@ -197,13 +286,23 @@ int fsimage_read_sector(disk_image_t *image, BYTE *buf, unsigned int track,
         if (image->type == DISK_IMAGE_TYPE_X64)
             offset += X64_HEADER_LENGTH;
 
-        fseek(fsimage->fd, offset, SEEK_SET);
-
-        if (fread((char *)buf, 256, 1, fsimage->fd) < 1) {
-            log_error(fsimage_log,
-                      "Error reading T:%i S:%i from disk image.",
-                      track, sector);
-            return -1;
+        if (fsimage->cache != NULL) {
+            if ((size_t)offset + 256 > fsimage->cache_size) {
+                log_error(fsimage_log,
+                          "Error reading T:%i S:%i from disk image.",
+                          track, sector);
+                return -1;
+            }
+            memcpy(buf, fsimage->cache + offset, 256);
+        } else {
+            fseek(fsimage->fd, offset, SEEK_SET);
+
+            if (fread((char *)buf, 256, 1, fsimage->fd) < 1) {
+                log_error(fsimage_log,
+                          "Error reading T:%i S:%i from disk image.",
+                          track, sector);
+                return -1;
+            }
         }
 
         if (fsimage->error_info != NULL) {
@@ -300,6 +399,12 @@ int fsimage_write_sector(disk_image_t *image, BYTE *buf, unsigned int track,
 
         /* Make sure the stream is visible to other readers.  */
         fflush(fsimage->fd);
+
+        if (fsimage->cache != NULL) {
+            if ((size_t)offset + 256 > fsimage->cache_size)
+                fsimage_cache_extend(fsimage, (size_t)offset + 256);
+            memcpy(fsimage->cache + offset, buf, 256);
+        }
         break;
       case DISK_IMAGE_TYPE_G64:
         if (fsimage_gcr_write_sector(image, buf, track, sector) < 0)
@@ -37,6 +37,9 @@ typedef struct fsimage_s {
     FILE *fd;
     char *name;
     BYTE *error_info;
+    /* In-memory copy of sector based images.  */
+    BYTE *cache;
+    size_t cache_size;
 } fsimage_t;
 
 
@@ -48,6 +51,8 @@ extern void fsimage_error_info_destroy(fsimage_t *fsimage);
 extern void fsimage_name_set(struct disk_image_s *image, char *name);
 extern char *fsimage_name_get(struct disk_image_s *image);
 extern void *fsimage_fd_get(disk_image_t *image);
+extern const BYTE *fsimage_memory_get(struct disk_image_s *image,
+                                      unsigned int *size);
 extern void fsimage_media_create(struct disk_image_s *image);
 extern void fsimage_media_destroy(struct disk_image_s *image);
 
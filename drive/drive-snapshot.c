@@ -36,6 +36,7 @@
 #include "drive-snapshot.h"
 #include "drive.h"
 #include "drivecpu.h"
+#include "driveimage.h"
 #include "drivemem.h"
 #include "driverom.h"
 #include "drivetypes.h"
@@ -335,6 +336,8 @@ int drive_snapshot_read_module(snapshot_t *s)
         drive->GCR_track_start_ptr = (drive->gcr->data
                                      + ((drive->current_half_track / 2 - 1)
                                      * NUM_MAX_BYTES_TRACK));
+        if (!drive->GCR_track_loaded[drive->current_half_track / 2 - 1])
+            drive_image_load_track(drive, drive->current_half_track / 2);
         if (drive->type != DRIVE_TYPE_1570
             && drive->type != DRIVE_TYPE_1571
             && drive->type != DRIVE_TYPE_1571CR) {
@@ -671,6 +674,12 @@ static int drive_snapshot_write_gcrimage_module(snapshot_t *s, unsigned int dnr)
     drive = drive_context[dnr]->drive;
     sprintf(snap_module_name, "GCRIMAGE%i", dnr);
 
+    /* Tracks not visited yet have not been encoded.  */
+    for (i = 1; i <= MAX_GCR_TRACKS; i++) {
+        if (!drive->GCR_track_loaded[i - 1])
+            drive_image_load_track(drive, i);
+    }
+
     m = snapshot_module_create(s, snap_module_name, GCRIMAGE_SNAP_MAJOR,
                                GCRIMAGE_SNAP_MINOR);
     if (m == NULL)
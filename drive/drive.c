@@ -458,11 +458,21 @@ void drive_set_half_track(int num, drive_t *dptr)
     if (num < 2)
         num = 2;
 
+    /* The track being left is decoded back to sectors when the image is
+       flushed.  */
+    if (dptr->GCR_dirty_track) {
+        dptr->GCR_track_dirty[dptr->current_half_track / 2 - 1] = 1;
+        dptr->GCR_dirty_track = 0;
+    }
+
     dptr->current_half_track = num;
     dptr->GCR_track_start_ptr = (dptr->gcr->data
                                 + ((dptr->current_half_track / 2 - 1)
                                 * NUM_MAX_BYTES_TRACK));
 
+    if (!dptr->GCR_track_loaded[num / 2 - 1])
+        drive_image_load_track(dptr, num / 2);
+
     if (dptr->GCR_current_track_size != 0)
 #if 0
         dptr->GCR_head_offset
@@ -487,7 +497,6 @@ void drive_set_half_track(int num, drive_t *dptr)
    for `step' are `+1' and `-1'.  */
 void drive_move_head(int step, drive_t *drive)
 {
-    drive_gcr_data_writeback(drive);
     if (drive->type == DRIVE_TYPE_1571
         || drive->type == DRIVE_TYPE_1571CR) {
         if (drive->current_half_track + step == 71)
@@ -499,13 +508,14 @@ void drive_move_head(int step, drive_t *drive)
 /* Hack... otherwise you get internal compiler errors when optimizing on
     gcc2.7.2 on RISC OS */
 static void gcr_data_writeback2(BYTE *buffer, BYTE *offset, unsigned int track,
-                                unsigned int sector, drive_t *drive)
+                                unsigned int sector, drive_t *drive,
+                                BYTE *gcr_track_start_ptr,
+                                unsigned int gcr_track_size)
 {
     int rc;
 
-    gcr_convert_GCR_to_sector(buffer, offset,
-                              drive->GCR_track_start_ptr,
-                              drive->GCR_current_track_size);
+    gcr_convert_GCR_to_sector(buffer, offset, gcr_track_start_ptr,
+                              gcr_track_size);
     if (buffer[0] != 0x7) {
         log_error(drive->log,
                   "Could not find data block id of T:%d S:%d.",
@@ -518,58 +528,46 @@ static void gcr_data_writeback2(BYTE *buffer, BYTE *offset, unsigned int track,
     }
 }
 
-void drive_gcr_data_writeback(drive_t *drive)
+/* Write the GCR data of `track' back to the image.  Returns -1 if this has
+   to be retried later, as the image has not been extended yet.  */
+static int drive_gcr_track_writeback(drive_t *drive, unsigned int track)
 {
     int extend;
-    unsigned int track, sector, max_sector = 0;
-    BYTE buffer[260], *offset;
+    unsigned int sector, max_sector = 0;
+    unsigned int gcr_track_size;
+    BYTE buffer[260], *offset, *gcr_track_start_ptr;
 
-    if (drive->image == NULL)
-        return;
-
-    track = drive->current_half_track / 2;
-
-    if (!(drive->GCR_dirty_track))
-        return;
+    gcr_track_size = drive->gcr->track_size[track - 1];
+    gcr_track_start_ptr = drive->gcr->data
+                          + ((track - 1) * NUM_MAX_BYTES_TRACK);
 
     if (drive->image->type == DISK_IMAGE_TYPE_G64) {
-        BYTE *gcr_track_start_ptr;
-        unsigned int gcr_current_track_size;
-
-        gcr_current_track_size = drive->gcr->track_size[track - 1];
-
-        gcr_track_start_ptr = drive->gcr->data
-                              + ((track - 1) * NUM_MAX_BYTES_TRACK);
-
-        disk_image_write_track(drive->image, track,
-                               gcr_current_track_size,
-                               drive->gcr->speed_zone,
-                               gcr_track_start_ptr);
-        drive->GCR_dirty_track = 0;
-        return;
+        disk_image_write_track(drive->image, track, gcr_track_size,
+                               drive->gcr->speed_zone, gcr_track_start_ptr);
+        return 0;
     }
 
     if (drive->image->type == DISK_IMAGE_TYPE_D64
         || drive->image->type == DISK_IMAGE_TYPE_X64) {
         if (track > EXT_TRACKS_1541)
-            return;
+            return 0;
         max_sector = disk_image_sector_per_track(DISK_IMAGE_TYPE_D64, track);
         if (track > drive->image->tracks) {
             switch (drive->extend_image_policy) {
               case DRIVE_EXTEND_NEVER:
                 drive->ask_extend_disk_image = 1;
-                return;
+                return -1;
               case DRIVE_EXTEND_ASK:
                 if (drive->ask_extend_disk_image == 1) {
                     extend = ui_extend_image_dialog();
                     if (extend == 0) {
                         drive->ask_extend_disk_image = 0;
-                        return;
+                        return -1;
                     } else {
                         drive_extend_disk_image(drive);
                     }
                 } else {
-                    return;
+                    return -1;
                 }
                 break;
               case DRIVE_EXTEND_ACCESS:
@@ -582,34 +580,54 @@ void drive_gcr_data_writeback(drive_t *drive)
 
     if (drive->image->type == DISK_IMAGE_TYPE_D71) {
         if (track > MAX_TRACKS_1571)
-            return;
+            return 0;
         max_sector = disk_image_sector_per_track(DISK_IMAGE_TYPE_D71, track);
     }
 
-    drive->GCR_dirty_track = 0;
-
     for (sector = 0; sector < max_sector; sector++) {
 
-        offset = gcr_find_sector_header(track, sector,
-                                        drive->GCR_track_start_ptr,
-                                        drive->GCR_current_track_size);
+        offset = gcr_find_sector_header(track, sector, gcr_track_start_ptr,
+                                        gcr_track_size);
         if (offset == NULL) {
             log_error(drive->log,
                       "Could not find header of T:%d S:%d.",
                       track, sector);
         } else {
-            offset = gcr_find_sector_data(offset,
-                                          drive->GCR_track_start_ptr,
-                                          drive->GCR_current_track_size);
+            offset = gcr_find_sector_data(offset, gcr_track_start_ptr,
+                                          gcr_track_size);
             if (offset == NULL) {
                 log_error(drive->log,
                           "Could not find data sync of T:%d S:%d.",
                           track, sector);
             } else {
-                gcr_data_writeback2(buffer, offset, track, sector, drive);
+                gcr_data_writeback2(buffer, offset, track, sector, drive,
+                                    gcr_track_start_ptr, gcr_track_size);
             }
         }
     }
+
+    return 0;
+}
+
+/* Write all tracks changed since the last flush back to the image.  */
+void drive_gcr_data_writeback(drive_t *drive)
+{
+    unsigned int track;
+
+    if (drive->image == NULL)
+        return;
+
+    if (drive->GCR_dirty_track) {
+        drive->GCR_track_dirty[drive->current_half_track / 2 - 1] = 1;
+        drive->GCR_dirty_track = 0;
+    }
+
+    for (track = 1; track <= MAX_GCR_TRACKS; track++) {
+        if (drive->GCR_track_dirty[track - 1]
+            && drive_gcr_track_writeback(drive, track) == 0) {
+            drive->GCR_track_dirty[track - 1] = 0;
+        }
+    }
 }
 
 void drive_gcr_data_writeback_all(void)
@@ -29,6 +29,7 @@
 #ifndef VICE_DRIVE_H
 #define VICE_DRIVE_H
 
+#include "gcr.h"
 #include "types.h"
 
 #define DRIVE_NUM 4
@@ -134,6 +135,11 @@ typedef struct drive_s {
     /* Flag: does the current need to be written out to disk?  */
     int GCR_dirty_track;
 
+    /* Per track flags: has the GCR data been encoded from the image yet,
+       and has it been written since the image was last flushed?  */
+    BYTE GCR_track_loaded[MAX_GCR_TRACKS];
+    BYTE GCR_track_dirty[MAX_GCR_TRACKS];
+
     /* GCR value being written to the disk.  */
     BYTE GCR_write_value;
 
@@ -86,17 +86,67 @@ static void drive_image_init_track_size_d71(drive_t *drive)
     }
 }
 
-static void drive_image_read_d64_d71(drive_t *drive)
+/* Encode the sectors of `track' to GCR.  D64/D71 images are converted
+   one track at a time, when the head first steps onto it.  */
+void drive_image_load_track(drive_t *drive, unsigned int track)
 {
     BYTE buffer[260], chksum;
+    BYTE *ptr;
     int i;
-    unsigned int track, sector;
+    unsigned int sector, max_sector;
 
-    if (!(drive->image))
+    if (drive->image == NULL)
+        return;
+
+    drive->GCR_track_loaded[track - 1] = 1;
+
+    if (track > drive->image->tracks)
         return;
 
     buffer[258] = buffer[259] = 0;
 
+    ptr = drive->gcr->data + GCR_OFFSET(track);
+    max_sector = disk_image_sector_per_track(drive->image->type, track);
+    /* Clear track to avoid read errors.  */
+    memset(ptr, 0xff, NUM_MAX_BYTES_TRACK);
+
+    for (sector = 0; sector < max_sector; sector++) {
+        int rc;
+        ptr = drive->gcr->data + sector_offset(track, sector,
+                                               max_sector, drive);
+
+        rc = disk_image_read_sector(drive->image, buffer + 1, track,
+                                    sector);
+        if (rc < 0) {
+            log_error(drive->log,
+                      "Cannot read T:%d S:%d from disk image.",
+                      track, sector);
+                      continue;
+        }
+
+        if (rc == 21) {
+            ptr = drive->gcr->data + GCR_OFFSET(track);
+            memset(ptr, 0x00, NUM_MAX_BYTES_TRACK);
+            break;
+        }
+
+        buffer[0] = (rc == 22) ? 0xff : 0x07;
+
+        chksum = buffer[1];
+        for (i = 2; i < 257; i++)
+            chksum ^= buffer[i];
+        buffer[257] = (rc == 23) ? chksum ^ 0xff : chksum;
+        gcr_convert_sector_to_GCR(buffer, ptr, track, sector,
+                                  drive->diskID1, drive->diskID2,
+                                  (BYTE)(rc));
+    }
+}
+
+static void drive_image_read_d64_d71(drive_t *drive)
+{
+    if (!(drive->image))
+        return;
+
     /* Since the D64/D71 format does not provide the actual track sizes or
        speed zones, we set them to standard values.  */
     if ((drive->image->type == DISK_IMAGE_TYPE_D64
@@ -116,49 +166,12 @@ static void drive_image_read_d64_d71(drive_t *drive)
         drive_image_init_track_size_d71(drive);
     }
 
-    drive_set_half_track(drive->current_half_track, drive);
+    /* Tracks are encoded on demand, starting with the one under the
+       head.  */
+    memset(drive->GCR_track_loaded, 0, sizeof(drive->GCR_track_loaded));
+    memset(drive->GCR_track_dirty, 0, sizeof(drive->GCR_track_dirty));
 
-    for (track = 1; track <= drive->image->tracks; track++) {
-        BYTE *ptr;
-        unsigned int max_sector = 0;
-
-        ptr = drive->gcr->data + GCR_OFFSET(track);
-        max_sector = disk_image_sector_per_track(drive->image->type,
-                                                 track);
-        /* Clear track to avoid read errors.  */
-        memset(ptr, 0xff, NUM_MAX_BYTES_TRACK);
-
-        for (sector = 0; sector < max_sector; sector++) {
-            int rc;
-            ptr = drive->gcr->data + sector_offset(track, sector,
-                                                   max_sector, drive);
-
-            rc = disk_image_read_sector(drive->image, buffer + 1, track,
-                                        sector);
-            if (rc < 0) {
-                log_error(drive->log,
-                          "Cannot read T:%d S:%d from disk image.",
-                          track, sector);
-                          continue;
-            }
-
-            if (rc == 21) {
-                ptr = drive->gcr->data + GCR_OFFSET(track);
-                memset(ptr, 0x00, NUM_MAX_BYTES_TRACK);
-                break;
-            }
-
-            buffer[0] = (rc == 22) ? 0xff : 0x07;
-
-            chksum = buffer[1];
-            for (i = 2; i < 257; i++)
-                chksum ^= buffer[i];
-            buffer[257] = (rc == 23) ? chksum ^ 0xff : chksum;
-            gcr_convert_sector_to_GCR(buffer, ptr, track, sector,
-                                      drive->diskID1, drive->diskID2,
-                                      (BYTE)(rc));
-        }
-    }
+    drive_set_half_track(drive->current_half_track, drive);
 }
 
 static int setID(unsigned int dnr)
@@ -280,6 +293,8 @@ int drive_image_attach(disk_image_t *image, unsigned int unit)
             drive->image = NULL;
             return -1;
         }
+        memset(drive->GCR_track_loaded, 1, sizeof(drive->GCR_track_loaded));
+        memset(drive->GCR_track_dirty, 0, sizeof(drive->GCR_track_dirty));
     } else {
         if (setID(dnr) >= 0) {
             drive_image_read_d64_d71(drive);
@@ -322,6 +337,8 @@ int drive_image_detach(disk_image_t *image, unsigned int unit)
 
     drive_gcr_data_writeback(drive);
     memset(drive->gcr->data, 0, MAX_GCR_TRACKS * NUM_MAX_BYTES_TRACK);
+    memset(drive->GCR_track_loaded, 0, sizeof(drive->GCR_track_loaded));
+    memset(drive->GCR_track_dirty, 0, sizeof(drive->GCR_track_dirty));
     drive->detach_clk = drive_clk[dnr];
     drive->GCR_image_loaded = 0;
     drive->read_only = 0;
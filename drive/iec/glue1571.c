@@ -40,8 +40,6 @@ void glue1571_side_set(unsigned int side, struct drive_s *drive)
     if (drive->byte_ready_active == 0x06)
         rotation_rotate_disk(drive);
 
-    drive_gcr_data_writeback(drive);
-
     drive->side = side;
     if (num > 70)
         num -= 70;
@@ -141,11 +141,12 @@ void iec_drive_vsync_hook(void)
 
 void iec_drive_rom_load(void)
 {
-    iecrom_load_1541();
-    iecrom_load_1541ii();
-    iecrom_load_1570();
-    iecrom_load_1571();
-    iecrom_load_1581();
+    unsigned int dnr;
+
+    /* Only the images of the configured drive types are loaded now, the
+       others follow when a drive is switched to their type.  */
+    for (dnr = 0; dnr < DRIVE_NUM; dnr++)
+        iecrom_check_loaded(drive_context[dnr]->drive->type);
 }
 
 void iec_drive_rom_setup_image(unsigned int dnr)
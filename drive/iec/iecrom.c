@@ -64,6 +64,14 @@ static unsigned int rom1570_loaded = 0;
 static unsigned int rom1571_loaded = 0;
 static unsigned int rom1581_loaded = 0;
 
+/* If nonzero, loading the ROM image has been attempted.  Images are only
+   loaded once a drive of their type is used, see `iecrom_check_loaded()'.  */
+static unsigned int rom1541_tried = 0;
+static unsigned int rom1541ii_tried = 0;
+static unsigned int rom1570_tried = 0;
+static unsigned int rom1571_tried = 0;
+static unsigned int rom1581_tried = 0;
+
 static unsigned int drive_rom1541_size;
 static unsigned int drive_rom1541ii_size;
 
@@ -105,6 +113,8 @@ int iecrom_load_1541(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1541_tried = 1;
+
     resources_get_string("DosName1541", &rom_name);
 
     filesize = sysfile_load(rom_name, drive_rom1541, DRIVE_ROM1541_SIZE,
@@ -132,6 +142,8 @@ int iecrom_load_1541ii(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1541ii_tried = 1;
+
     resources_get_string("DosName1541ii", &rom_name);
 
     filesize = sysfile_load(rom_name, drive_rom1541ii, DRIVE_ROM1541II_SIZE,
@@ -157,6 +169,8 @@ int iecrom_load_1570(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1570_tried = 1;
+
     resources_get_string("DosName1570", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom1570, DRIVE_ROM1571_SIZE,
@@ -179,6 +193,8 @@ int iecrom_load_1571(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1571_tried = 1;
+
     resources_get_string("DosName1571", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom1571, DRIVE_ROM1571_SIZE,
@@ -201,6 +217,8 @@ int iecrom_load_1581(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1581_tried = 1;
+
     resources_get_string("DosName1581", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom1581, DRIVE_ROM1581_SIZE,
@@ -280,35 +298,61 @@ int iecrom_read(unsigned int type, WORD addr, BYTE *data)
     return -1;
 }
 
+static int iecrom_any_loaded(void)
+{
+    return (rom1541_loaded || rom1541ii_loaded || rom1570_loaded
+            || rom1571_loaded || rom1581_loaded);
+}
+
 int iecrom_check_loaded(unsigned int type)
 {
     switch (type) {
       case DRIVE_TYPE_NONE:
         return 0;
       case DRIVE_TYPE_1541:
+        if (!rom1541_tried)
+            iecrom_load_1541();
         if (rom1541_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_1541II:
+        if (!rom1541ii_tried)
+            iecrom_load_1541ii();
         if (rom1541ii_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_1570:
+        if (!rom1570_tried)
+            iecrom_load_1570();
         if (rom1570_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_1571:
+        if (!rom1571_tried)
+            iecrom_load_1571();
         if (rom1571_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_1581:
+        if (!rom1581_tried)
+            iecrom_load_1581();
         if (rom1581_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_ANY:
-        if ((!rom1541_loaded && !rom1541ii_loaded && !rom1570_loaded
-            && !rom1571_loaded && !rom1581_loaded)
-            && rom_loaded)
+        /* The images are loaded lazily, so probe the ones not tried yet
+           until one is found.  */
+        if (!iecrom_any_loaded() && !rom1541_tried)
+            iecrom_load_1541();
+        if (!iecrom_any_loaded() && !rom1541ii_tried)
+            iecrom_load_1541ii();
+        if (!iecrom_any_loaded() && !rom1570_tried)
+            iecrom_load_1570();
+        if (!iecrom_any_loaded() && !rom1571_tried)
+            iecrom_load_1571();
+        if (!iecrom_any_loaded() && !rom1581_tried)
+            iecrom_load_1581();
+        if (!iecrom_any_loaded() && rom_loaded)
             return -1;
         break;
       default:
@@ -121,11 +121,12 @@ void ieee_drive_setup_context(struct drive_context_s *drv)
 
 void ieee_drive_rom_load(void)
 {
-    ieeerom_load_2031();
-    ieeerom_load_2040();
-    ieeerom_load_3040();
-    ieeerom_load_4040();
-    ieeerom_load_1001();
+    unsigned int dnr;
+
+    /* Only the images of the configured drive types are loaded now, the
+       others follow when a drive is switched to their type.  */
+    for (dnr = 0; dnr < DRIVE_NUM; dnr++)
+        ieeerom_check_loaded(drive_context[dnr]->drive->type);
 }
 
 void ieee_drive_rom_setup_image(unsigned int dnr)
@@ -62,6 +62,14 @@ static unsigned int rom3040_loaded = 0;
 static unsigned int rom4040_loaded = 0;
 static unsigned int rom1001_loaded = 0;
 
+/* If nonzero, loading the ROM image has been attempted.  Images are only
+   loaded once a drive of their type is used, see `ieeerom_check_loaded()'.  */
+static unsigned int rom2031_tried = 0;
+static unsigned int rom2040_tried = 0;
+static unsigned int rom3040_tried = 0;
+static unsigned int rom4040_tried = 0;
+static unsigned int rom1001_tried = 0;
+
 
 static void ieeerom_new_image_loaded(unsigned int dtype)
 {
@@ -83,6 +91,8 @@ int ieeerom_load_2031(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom2031_tried = 1;
+
     resources_get_string("DosName2031", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom2031, DRIVE_ROM2031_SIZE,
@@ -105,6 +115,8 @@ int ieeerom_load_2040(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom2040_tried = 1;
+
     resources_get_string("DosName2040", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom2040, DRIVE_ROM2040_SIZE,
@@ -127,6 +139,8 @@ int ieeerom_load_3040(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom3040_tried = 1;
+
     resources_get_string("DosName3040", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom3040, DRIVE_ROM3040_SIZE,
@@ -149,6 +163,8 @@ int ieeerom_load_4040(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom4040_tried = 1;
+
     resources_get_string("DosName4040", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom4040, DRIVE_ROM4040_SIZE,
@@ -171,6 +187,8 @@ int ieeerom_load_1001(void)
     if (!drive_rom_load_ok)
         return 0;
 
+    rom1001_tried = 1;
+
     resources_get_string("DosName1001", &rom_name);
 
     if (sysfile_load(rom_name, drive_rom1001, DRIVE_ROM1001_SIZE,
@@ -241,36 +259,63 @@ int ieeerom_read(unsigned int type, WORD addr, BYTE *data)
     return -1;
 }
 
+static int ieeerom_any_loaded(void)
+{
+    return (rom2031_loaded || rom2040_loaded || rom3040_loaded
+            || rom4040_loaded || rom1001_loaded);
+}
+
 int ieeerom_check_loaded(unsigned int type)
 {
     switch (type) {
       case DRIVE_TYPE_NONE:
         return 0;
       case DRIVE_TYPE_2031:
+        if (!rom2031_tried)
+            ieeerom_load_2031();
         if (rom2031_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_2040:
+        if (!rom2040_tried)
+            ieeerom_load_2040();
         if (rom2040_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_3040:
+        if (!rom3040_tried)
+            ieeerom_load_3040();
         if (rom3040_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_4040:
+        if (!rom4040_tried)
+            ieeerom_load_4040();
         if (rom4040_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_1001:
       case DRIVE_TYPE_8050:
       case DRIVE_TYPE_8250:
+        if (!rom1001_tried)
+            ieeerom_load_1001();
         if (rom1001_loaded < 1 && rom_loaded)
             return -1;
         break;
       case DRIVE_TYPE_ANY:
-        if ((!rom2031_loaded && !rom2040_loaded && !rom3040_loaded
-            && !rom4040_loaded && !rom1001_loaded) && rom_loaded)
+        /* The images are loaded lazily, so probe the ones not tried yet
+           until one is found.  */
+        if (!ieeerom_any_loaded() && !rom2031_tried)
+            ieeerom_load_2031();
+        if (!ieeerom_any_loaded() && !rom2040_tried)
+            ieeerom_load_2040();
+        if (!ieeerom_any_loaded() && !rom3040_tried)
+            ieeerom_load_3040();
+        if (!ieeerom_any_loaded() && !rom4040_tried)
+            ieeerom_load_4040();
+        if (!ieeerom_any_loaded() && !rom1001_tried)
+            ieeerom_load_1001();
+        if (!ieeerom_any_loaded() && rom_loaded)
             return -1;
         break;
       default:
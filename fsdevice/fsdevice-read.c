@@ -51,6 +51,28 @@
 #include "vdrive.h"
 
 
+/* Host files are read in chunks of this size and served from memory.  */
+#define FSDEVICE_READBUF_SIZE 0x4000
+
+static unsigned int read_file_byte(bufinfo_t *bufinfo, BYTE *data)
+{
+    if (bufinfo->readbuf_pos >= bufinfo->readbuf_len) {
+        if (bufinfo->readbuf == NULL)
+            bufinfo->readbuf = lib_malloc(FSDEVICE_READBUF_SIZE);
+
+        bufinfo->readbuf_len = fileio_read(bufinfo->fileio_info,
+                                           bufinfo->readbuf,
+                                           FSDEVICE_READBUF_SIZE);
+        bufinfo->readbuf_pos = 0;
+
+        if (bufinfo->readbuf_len == 0)
+            return 0;
+    }
+
+    *data = bufinfo->readbuf[bufinfo->readbuf_pos++];
+    return 1;
+}
+
 static int command_read(bufinfo_t *bufinfo, BYTE *data)
 {
     if (bufinfo->tape->name) {
@@ -108,8 +130,8 @@ static int command_read(bufinfo_t *bufinfo, BYTE *data)
             }
             /* If this is our first read, read in first byte */
             if (!bufinfo->isbuffered) {
-                bufinfo->iseof = !fileio_read(bufinfo->fileio_info,
-                                 &(bufinfo->buffered), 1);
+                bufinfo->iseof = !read_file_byte(bufinfo,
+                                                 &(bufinfo->buffered));
                 /* We shouldn't get an EOF at this point */
                 /* Check for errors */
                 if (fileio_ferror(bufinfo->fileio_info))
@@ -118,8 +140,7 @@ static int command_read(bufinfo_t *bufinfo, BYTE *data)
             /* Place it in the output field */
             *data = bufinfo->buffered;
             /* Read the next buffer; if nothing read, set EOF signal */
-            bufinfo->iseof = !fileio_read(bufinfo->fileio_info,
-                             &(bufinfo->buffered), 1);
+            bufinfo->iseof = !read_file_byte(bufinfo, &(bufinfo->buffered));
             /* Check for errors */
             if (fileio_ferror(bufinfo->fileio_info))
                 return SERIAL_ERROR;
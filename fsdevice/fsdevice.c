@@ -216,6 +216,7 @@ void fsdevice_shutdown(void)
             lib_free(bufinfo[j].dir);
             lib_free(bufinfo[j].name);
             lib_free(bufinfo[j].dirmask);
+            lib_free(bufinfo[j].readbuf);
         }
 
         lib_free(fsdevice_dev[i].errorl);
@@ -55,6 +55,9 @@ struct bufinfo_s {
     BYTE buffered;  /* Buffered Byte: Added to buffer reads to remove buffering from iec code */
     int isbuffered; /* TRUE is a byte exists in the buffer above */
     int iseof;      /* TRUE if an EOF is detected on a buffered read */
+    BYTE *readbuf;  /* Read-ahead buffer for host files */
+    unsigned int readbuf_len;
+    unsigned int readbuf_pos;
     char *dirmask;
 };
 typedef struct bufinfo_s bufinfo_t;
@@ -31,6 +31,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "archdep.h"
+#include "attach.h"
 #include "cbmdos.h"
 #include "diskcontents-block.h"
 #include "diskimage.h"
@@ -42,6 +44,9 @@
 #include "vdrive-internal.h"
 #include "vdrive.h"
 #include "machine-drive.h"
+#include "diskconstants.h"
+#include "util.h"
+#include "zfile.h"
 
 
 /* This code is used to check whether the directory is circular.  It should
@@ -87,6 +92,50 @@ static int circular_check(unsigned int track, unsigned int sector)
     return 0;
 }
 
+/* Append the files of the directory sector in `buffer' to the list of
+   `contents'; `*lp' points to the last entry added so far.  */
+static void diskcontents_block_add_files(image_contents_t *contents,
+                                         image_contents_file_list_t **lp,
+                                         const BYTE *buffer)
+{
+    const BYTE *p;
+    int j;
+
+    for (p = buffer, j = 0; j < 8; j++, p += 32)
+        if (p[SLOT_TYPE_OFFSET] != 0) {
+            image_contents_file_list_t *new_list;
+            int i;
+
+            new_list = lib_malloc(sizeof(image_contents_file_list_t));
+            new_list->size = ((int)p[SLOT_NR_BLOCKS]
+                              + ((int)p[SLOT_NR_BLOCKS + 1] << 8));
+
+            for (i = 0; i < IMAGE_CONTENTS_FILE_NAME_LEN; i++)
+                    new_list->name[i] = p[SLOT_NAME_OFFSET + i];
+
+            new_list->name[IMAGE_CONTENTS_FILE_NAME_LEN] = 0;
+
+            new_list->name[i] = 0;
+
+            sprintf((char *)new_list->type, "%c%s%c",
+                    (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_CLOSED ? ' ' : '*'),
+                    cbmdos_filetype_get(p[SLOT_TYPE_OFFSET] & 0x07),
+                    (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_LOCKED ? '<' : ' '));
+
+            new_list->next = NULL;
+
+            if (*lp == NULL) {
+                new_list->prev = NULL;
+                contents->file_list = new_list;
+                *lp = contents->file_list;
+            } else {
+                new_list->prev = *lp;
+                (*lp)->next = new_list;
+                *lp = new_list;
+            }
+        }
+}
+
 image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
 {
     image_contents_t *contents;
@@ -126,9 +175,6 @@ image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
     circular_check_init();
 
     while (1) {
-        BYTE *p;
-        int j;
-
         retval = disk_image_read_sector(vdrive->image, buffer,
                                         vdrive->Curr_track,
                                         vdrive->Curr_sector);
@@ -140,48 +186,285 @@ image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
             return contents/*NULL*/;
         }
 
-        for (p = buffer, j = 0; j < 8; j++, p += 32)
-            if (p[SLOT_TYPE_OFFSET] != 0) {
-                image_contents_file_list_t *new_list;
-                int i;
+        diskcontents_block_add_files(contents, &lp, buffer);
 
-                new_list = lib_malloc(sizeof(image_contents_file_list_t));
-                new_list->size = ((int)p[SLOT_NR_BLOCKS]
-                                  + ((int)p[SLOT_NR_BLOCKS + 1] << 8));
+        if (buffer[0] == 0)
+            break;
+
+        vdrive->Curr_track = (int)buffer[0];
+        vdrive->Curr_sector = (int)buffer[1];
+    }
+
+    vdrive_internal_close_disk_image(vdrive);
+    return contents;
+}
 
-                for (i = 0; i < IMAGE_CONTENTS_FILE_NAME_LEN; i++)
-                        new_list->name[i] = p[SLOT_NAME_OFFSET + i];
 
-                new_list->name[IMAGE_CONTENTS_FILE_NAME_LEN] = 0;
+/* ------------------------------------------------------------------------- */
 
-                new_list->name[i] = 0;
+/* Fast path for plain D64, D71 and D81 files: the directory is parsed
+   straight from the image file, one whole track per read, without probing
+   the image and attaching it to a virtual drive.  If the file is attached
+   to a drive, the in-memory copy of the attached image is used instead, so
+   the listing shows what the drive sees.  Other image types return NULL so
+   the caller can fall back to `diskcontents_block_read()'.  */
 
-                sprintf((char *)new_list->type, "%c%s%c",
-                        (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_CLOSED ? ' ' : '*'),
-                        cbmdos_filetype_get(p[SLOT_TYPE_OFFSET] & 0x07),
-                        (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_LOCKED ? '<' : ' '));
+typedef struct diskcontents_image_s {
+    FILE *fd;
+    /* In-memory copy of an attached image, NULL to read `fd'.  */
+    const BYTE *data;
+    size_t size;
+    unsigned int type;
+    unsigned int tracks;
 
-                new_list->next = NULL;
+    /* The track currently held in `track_data', 0 if none.  */
+    unsigned int track;
+    unsigned int num_sectors;
+    const BYTE *track_data;
+} diskcontents_image_t;
 
-                if (lp == NULL) {
-                    new_list->prev = NULL;
-                    contents->file_list = new_list;
-                    lp = contents->file_list;
-                } else {
-                    new_list->prev = lp;
-                    lp->next = new_list;
-                    lp = new_list;
-                }
-            }
+/* Track buffer, kept between calls so that scanning many images in a row
+   does not allocate for each of them.  */
+static BYTE *track_buffer = NULL;
+
+static int diskcontents_image_probe(diskcontents_image_t *image)
+{
+    size_t blocks;
+    unsigned int tracks;
+
+    blocks = D64_FILE_SIZE_35 / 256;
+    for (tracks = NUM_TRACKS_1541; tracks <= MAX_TRACKS_1541; tracks++) {
+        if (image->size == blocks * 256 || image->size == blocks * 257) {
+            image->type = DISK_IMAGE_TYPE_D64;
+            image->tracks = tracks;
+            return 0;
+        }
+        blocks += 17;
+    }
+
+    if (image->size == D71_FILE_SIZE || image->size == D71_FILE_SIZE_E) {
+        image->type = DISK_IMAGE_TYPE_D71;
+        image->tracks = NUM_TRACKS_1571;
+        return 0;
+    }
+
+    if (image->size == D81_FILE_SIZE) {
+        image->type = DISK_IMAGE_TYPE_D81;
+        image->tracks = NUM_TRACKS_1581;
+        return 0;
+    }
+
+    return -1;
+}
+
+static int diskcontents_image_load_track(diskcontents_image_t *image,
+                                         unsigned int track)
+{
+    unsigned int first, i, side_track;
+    size_t len;
+
+    if (track == image->track)
+        return 0;
+
+    image->track = 0;
+
+    if (track < 1 || track > image->tracks)
+        return -1;
+
+    first = 0;
+
+    if (image->type == DISK_IMAGE_TYPE_D81) {
+        first = (track - 1) * NUM_SECTORS_1581;
+        image->num_sectors = NUM_SECTORS_1581;
+    } else {
+        side_track = track;
+        if (image->type == DISK_IMAGE_TYPE_D71
+            && side_track > NUM_TRACKS_1541) {
+            side_track -= NUM_TRACKS_1541;
+            first = NUM_BLOCKS_1541;
+        }
+        for (i = 1; i < side_track; i++)
+            first += disk_image_sector_per_track(DISK_IMAGE_TYPE_D64, i);
+        image->num_sectors = disk_image_sector_per_track(DISK_IMAGE_TYPE_D64,
+                                                         side_track);
+    }
+
+    len = image->num_sectors * 256;
+
+    if ((size_t)first * 256 + len > image->size)
+        return -1;
+
+    if (image->data != NULL) {
+        image->track_data = image->data + (size_t)first * 256;
+    } else {
+        if (fseek(image->fd, (long)first * 256, SEEK_SET) != 0
+            || fread(track_buffer, 1, len, image->fd) != len)
+            return -1;
+        image->track_data = track_buffer;
+    }
+
+    image->track = track;
+    return 0;
+}
+
+static const BYTE *diskcontents_image_sector(diskcontents_image_t *image,
+                                             unsigned int track,
+                                             unsigned int sector)
+{
+    if (diskcontents_image_load_track(image, track) < 0
+        || sector >= image->num_sectors)
+        return NULL;
+
+    return image->track_data + sector * 256;
+}
+
+/* Return the in-memory copy of `file_name' if it is attached to a drive.  */
+static const BYTE *diskcontents_attached_image(const char *file_name,
+                                               size_t *size)
+{
+    unsigned int unit, len;
+    vdrive_t *vdrive;
+    const char *name;
+    const BYTE *data;
+
+    for (unit = 8; unit < 12; unit++) {
+        vdrive = file_system_get_vdrive(unit);
+        if (vdrive == NULL || vdrive->image == NULL)
+            continue;
+
+        name = disk_image_name_get(vdrive->image);
+        if (name == NULL || strcmp(name, file_name) != 0)
+            continue;
+
+        data = disk_image_fsimage_memory_get(vdrive->image, &len);
+        if (data != NULL) {
+            *size = len;
+            return data;
+        }
+    }
+
+    return NULL;
+}
+
+image_contents_t *diskcontents_block_read_image(const char *file_name)
+{
+    diskcontents_image_t image;
+    image_contents_t *contents;
+    image_contents_file_list_t *lp;
+    vdrive_t *vdrive;
+    const BYTE *buffer;
+    unsigned int track, sector, i;
+
+    machine_drive_flush();
+
+    memset(&image, 0, sizeof(image));
+
+    image.data = diskcontents_attached_image(file_name, &image.size);
+
+    if (image.data == NULL) {
+        image.fd = zfile_fopen(file_name, MODE_READ);
+        if (image.fd == NULL)
+            return NULL;
+        image.size = util_file_length(image.fd);
+    }
+
+    if (diskcontents_image_probe(&image) < 0) {
+        if (image.fd != NULL)
+            zfile_fclose(image.fd);
+        return NULL;
+    }
+
+    if (track_buffer == NULL)
+        track_buffer = lib_malloc(NUM_SECTORS_1581 * 256);
+
+    /* Only the fields `vdrive_bam_free_block_count()' looks at are set up
+       in this drive.  */
+    vdrive = lib_calloc(1, sizeof(vdrive_t));
+    vdrive->num_tracks = image.tracks;
+
+    switch (image.type) {
+      case DISK_IMAGE_TYPE_D64:
+        vdrive->image_format = VDRIVE_IMAGE_FORMAT_1541;
+        vdrive->Dir_Track = DIR_TRACK_1541;
+        vdrive->Dir_Sector = DIR_SECTOR_1541;
+        vdrive->bam_name = BAM_NAME_1541;
+        vdrive->bam_id = BAM_ID_1541;
+        buffer = diskcontents_image_sector(&image, BAM_TRACK_1541,
+                                           BAM_SECTOR_1541);
+        if (buffer != NULL)
+            memcpy(vdrive->bam, buffer, 256);
+        break;
+      case DISK_IMAGE_TYPE_D71:
+        vdrive->image_format = VDRIVE_IMAGE_FORMAT_1571;
+        vdrive->Dir_Track = DIR_TRACK_1571;
+        vdrive->Dir_Sector = DIR_SECTOR_1571;
+        vdrive->bam_name = BAM_NAME_1571;
+        vdrive->bam_id = BAM_ID_1571;
+        buffer = diskcontents_image_sector(&image, BAM_TRACK_1571,
+                                           BAM_SECTOR_1571);
+        if (buffer != NULL)
+            memcpy(vdrive->bam, buffer, 256);
+        break;
+      default:
+        vdrive->image_format = VDRIVE_IMAGE_FORMAT_1581;
+        vdrive->Dir_Track = DIR_TRACK_1581;
+        vdrive->Dir_Sector = DIR_SECTOR_1581;
+        vdrive->bam_name = BAM_NAME_1581;
+        vdrive->bam_id = BAM_ID_1581;
+        for (i = 0, buffer = NULL; i < 3; i++) {
+            buffer = diskcontents_image_sector(&image, BAM_TRACK_1581,
+                                               BAM_SECTOR_1581 + i);
+            if (buffer == NULL)
+                break;
+            memcpy(vdrive->bam + i * 256, buffer, 256);
+        }
+        break;
+    }
+
+    if (buffer == NULL) {
+        lib_free(vdrive);
+        if (image.fd != NULL)
+            zfile_fclose(image.fd);
+        return NULL;
+    }
+
+    contents = image_contents_new();
+
+    memcpy(contents->name, vdrive->bam + vdrive->bam_name,
+           IMAGE_CONTENTS_NAME_LEN);
+    contents->name[IMAGE_CONTENTS_NAME_LEN] = 0;
+
+    memcpy(contents->id, vdrive->bam + vdrive->bam_id, IMAGE_CONTENTS_ID_LEN);
+    contents->id[IMAGE_CONTENTS_ID_LEN] = 0;
+
+    contents->blocks_free = (int)vdrive_bam_free_block_count(vdrive);
+
+    track = vdrive->Dir_Track;
+    sector = vdrive->Dir_Sector;
+
+    lib_free(vdrive);
+
+    lp = NULL;
+    contents->file_list = NULL;
+
+    circular_check_init();
+
+    while (1) {
+        buffer = diskcontents_image_sector(&image, track, sector);
+
+        if (buffer == NULL || circular_check(track, sector))
+            break;
+
+        diskcontents_block_add_files(contents, &lp, buffer);
 
         if (buffer[0] == 0)
             break;
 
-        vdrive->Curr_track = (int)buffer[0];
-        vdrive->Curr_sector = (int)buffer[1];
+        track = (unsigned int)buffer[0];
+        sector = (unsigned int)buffer[1];
     }
 
-    vdrive_internal_close_disk_image(vdrive);
+    if (image.fd != NULL)
+        zfile_fclose(image.fd);
     return contents;
 }
-
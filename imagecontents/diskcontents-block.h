@@ -31,6 +31,7 @@ struct image_contents_s;
 struct vdrive_s;
 
 extern struct image_contents_s *diskcontents_block_read(struct vdrive_s *vdrive);
+extern struct image_contents_s *diskcontents_block_read_image(const char *file_name);
 
 #endif
 
@@ -56,6 +56,12 @@ image_contents_t *diskcontents_read(const char *file_name, unsigned int unit)
 
 image_contents_t *diskcontents_filesystem_read(const char *file_name)
 {
+    image_contents_t *contents;
+
+    contents = diskcontents_block_read_image(file_name);
+    if (contents != NULL)
+        return contents;
+
     return diskcontents_block_read(vdrive_internal_open_fsimage(file_name, 1));
 }
 
@@ -30,6 +30,7 @@
 #include "archdep.h"
 #include "attach.h"
 #include "autostart.h"
+#include "batchjob.h"
 #include "cmdline.h"
 #include "console.h"
 #include "debug.h"
@@ -50,6 +51,7 @@
 #include "machine.h"
 #include "maincpu.h"
 #include "monitor.h"
+#include "monitor_cputrace.h"
 #ifdef HAVE_NETWORK
 #include "monitor_network.h"
 #endif
@@ -63,6 +65,22 @@
 #include "sysfile.h"
 #include "uiapi.h"
 #include "vdrive.h"
+#include "vsyncapi.h"
+#include "zfile.h"
+
+
+/* Startup phase timing, see `init_timing_mark()'.  */
+#define INIT_TIMING_MAX 32
+
+struct init_timing_s {
+    const char *phase;
+    unsigned long time;
+};
+typedef struct init_timing_s init_timing_t;
+
+static init_timing_t init_timing[INIT_TIMING_MAX];
+static unsigned int init_timing_num = 0;
+static int init_timing_enabled = 0;
 
 
 static void init_resource_fail(const char *module)
@@ -85,6 +103,10 @@ int init_resources(void)
         init_resource_fail("system file locator");
         return -1;
     }
+    if (zfile_resources_init() < 0) {
+        init_resource_fail("zfile");
+        return -1;
+    }
     if (autostart_resources_init() < 0) {
         init_resource_fail("autostart");
         return -1;
@@ -142,6 +164,14 @@ int init_resources(void)
         init_resource_fail("network");
         return -1;
     }
+    if (monitor_resources_init() < 0) {
+        init_resource_fail("monitor");
+        return -1;
+    }
+    if (monitor_cputrace_resources_init() < 0) {
+        init_resource_fail("CPU trace");
+        return -1;
+    }
 #ifdef HAVE_NETWORK
     if (monitor_network_resources_init() < 0) {
         init_resource_fail("monitor");
@@ -175,6 +205,10 @@ int init_cmdline_options(void)
         init_cmdline_options_fail("system file locator");
         return -1;
     }
+    if (zfile_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("zfile");
+        return -1;
+    }
     if ((!(vsid_mode && video_disabled_mode)) && ui_cmdline_options_init() < 0) {
         init_cmdline_options_fail("UI");
         return -1;
@@ -203,6 +237,14 @@ int init_cmdline_options(void)
         init_cmdline_options_fail("monitor");
         return -1;
     }
+    if (monitor_cputrace_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("CPU trace");
+        return -1;
+    }
+    if (!vsid_mode && batchjob_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("batch job");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_cmdline_options_init() < 0) {
         init_cmdline_options_fail("debug");
@@ -243,6 +285,45 @@ int init_cmdline_options(void)
     return 0;
 }
 
+/* Record the end of the startup phase `phase'.  The marks are always
+   taken, as the command line enabling the report is only parsed halfway
+   through the startup; the first mark only sets the starting time.  */
+void init_timing_mark(const char *phase)
+{
+    if (init_timing_num >= INIT_TIMING_MAX)
+        return;
+
+    init_timing[init_timing_num].phase = phase;
+    init_timing[init_timing_num].time = vsyncarch_gettime();
+    init_timing_num++;
+}
+
+void init_timing_enable(void)
+{
+    init_timing_enabled = 1;
+}
+
+void init_timing_report(void)
+{
+    unsigned int i;
+    double freq;
+
+    if (!init_timing_enabled || init_timing_num < 2)
+        return;
+
+    freq = (double)vsyncarch_frequency();
+
+    log_message(LOG_DEFAULT, "Startup timing:");
+    for (i = 1; i < init_timing_num; i++) {
+        log_message(LOG_DEFAULT, "  %-24s %9.2f ms", init_timing[i].phase,
+                    (double)(init_timing[i].time - init_timing[i - 1].time)
+                    * 1000.0 / freq);
+    }
+    log_message(LOG_DEFAULT, "  %-24s %9.2f ms", "total",
+                (double)(init_timing[init_timing_num - 1].time
+                - init_timing[0].time) * 1000.0 / freq);
+}
+
 int init_main(void)
 {
     signals_init(debug.do_core_dumps);
@@ -253,6 +334,8 @@ int init_main(void)
         palette_init();
     }
 
+    init_timing_mark("romset, palette");
+
     if (!vsid_mode) {
         gfxoutput_init();
         screenshot_init();
@@ -265,12 +348,16 @@ int init_main(void)
 
     event_init();
 
+    init_timing_mark("gfxoutput, CPUs");
+
     /* Machine-specific initialization.  */
     if (machine_init() < 0) {
         log_error(LOG_DEFAULT, "Machine initialization failed.");
         return -1;
     }
 
+    init_timing_mark("machine");
+
     /* FIXME: what's about uimon_init??? */
     if (!vsid_mode && console_init() < 0) {
         log_error(LOG_DEFAULT, "Console initialization failed.");
@@ -290,6 +377,8 @@ int init_main(void)
 
     ui_init_finalize();
 
+    init_timing_mark("console, keyboard, disk");
+
     return 0;
 }
 
@@ -31,5 +31,9 @@ extern int init_resources(void);
 extern int init_cmdline_options(void);
 extern int init_main(void);
 
+extern void init_timing_mark(const char *phase);
+extern void init_timing_enable(void);
+extern void init_timing_report(void);
+
 #endif
 
@@ -37,6 +37,7 @@
 #include "autostart.h"
 #include "charset.h"
 #include "cmdline.h"
+#include "init.h"
 #include "initcmdline.h"
 #include "lib.h"
 #include "log.h"
@@ -96,6 +97,12 @@ static int cmdline_autoload(const char *param, void *extra_param)
     return 0;
 }
 
+static int cmdline_startup_time(const char *param, void *extra_param)
+{
+    init_timing_enable();
+    return 0;
+}
+
 #if !defined(__OS2__) && !defined(__BEOS__)
 static int cmdline_console(const char *param, void *extra_param)
 {
@@ -145,6 +152,11 @@ static const cmdline_option_t common_cmdline_options[] = {
       USE_PARAM_STRING, USE_DESCRIPTION_ID,
       IDCLS_UNUSED, IDCLS_SHOW_COMMAND_LINE_OPTIONS,
       NULL, NULL },
+    { "-startuptime", CALL_FUNCTION, 0,
+      cmdline_startup_time, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      NULL, T_("Log the time spent in each startup phase") },
 #if (!defined  __OS2__ && !defined __BEOS__)
     { "-console", CALL_FUNCTION, 0,
       cmdline_console, NULL, NULL, NULL,
@@ -34,6 +34,7 @@
 #include "archdep.h"
 #include "attach.h"
 #include "autostart.h"
+#include "batchjob.h"
 #include "clkguard.h"
 #include "cmdline.h"
 #include "console.h"
@@ -53,6 +54,7 @@
 #include "maincpu.h"
 #include "mem.h"
 #include "monitor.h"
+#include "monitor_cputrace.h"
 #ifdef HAVE_NETWORK
 #include "monitor_network.h"
 #endif
@@ -264,6 +266,8 @@ void machine_shutdown(void)
     log_resources_shutdown();
     fliplist_resources_shutdown();
     romset_resources_shutdown();
+    monitor_cputrace_resources_shutdown();
+    batchjob_shutdown();
 #ifdef HAVE_NETWORK
     monitor_network_resources_shutdown();
 #endif
@@ -57,6 +57,7 @@
 #include "maincpu.h"
 #include "main.h"
 #include "resources.h"
+#include "sid-bench.h"
 #include "sysfile.h"
 #ifdef HAS_TRANSLATION
 #include "translate.h"
@@ -126,6 +127,8 @@ int main_program(int argc, char **argv)
     textdomain(PACKAGE);
 #endif
     
+    init_timing_mark(NULL);
+
     archdep_init(&argc, argv);
 
 #ifndef __riscos
@@ -145,9 +148,13 @@ int main_program(int argc, char **argv)
 
     gfxoutput_early_init();
 
+    init_timing_mark("early init");
+
     if (init_resources() < 0 || init_cmdline_options() < 0)
         return -1;
 
+    init_timing_mark("resources, options");
+
     /* Set factory defaults.  */
     if (resources_set_defaults() < 0) {
         archdep_startup_log_error("Cannot set defaults.\n");
@@ -162,6 +169,8 @@ int main_program(int argc, char **argv)
         return -1;
     }
 
+    init_timing_mark("defaults, UI");
+
 #ifdef HAS_TRANSLATION
    /* set the default arch language */
     translate_arch_language_init();
@@ -199,9 +208,13 @@ int main_program(int argc, char **argv)
     if (log_init() < 0)
         archdep_startup_log_error("Cannot startup logging system.\n");
 
+    init_timing_mark("resource file");
+
     if (initcmdline_check_args(argc, argv) < 0)
         return -1;
 
+    init_timing_mark("command line");
+
     program_name = archdep_program_name();
 
     /* VICE boot sequence.  */
@@ -233,11 +246,18 @@ int main_program(int argc, char **argv)
     if (initcmdline_check_psid() < 0)
         return -1;
 
+    init_timing_mark("UI finish, video");
+
     if (init_main() < 0)
         return -1;
 
+    sid_bench_check();
+
     initcmdline_check_attach();
 
+    init_timing_mark("attach, autostart");
+    init_timing_report();
+
     init_done = 1;
 
     /* Let's go...  */
@@ -136,6 +136,7 @@ extern void monitor_init(monitor_interface_t *maincpu_interface,
                          monitor_interface_t *drive_interface_init[],
                          struct monitor_cpu_type_s **asmarray);
 extern void monitor_shutdown(void);
+extern int monitor_resources_init(void);
 extern int monitor_cmdline_options_init(void);
 extern void monitor_startup(void);
 extern void monitor_startup_trap(void);
@@ -199,6 +200,13 @@ extern void monitor_cpuhistory_store(unsigned int addr, unsigned int op, unsigne
                                      BYTE reg_a, BYTE reg_x, BYTE reg_y, 
                                      BYTE reg_sp, unsigned int reg_st);
 extern void monitor_memmap_store(unsigned int addr, unsigned int type);
+extern void monitor_memmap_frame(void);
+
+/* CPU trace prototypes, see monitor_cputrace.c */
+extern int monitor_cputrace_enabled;
+extern void monitor_cputrace_store(unsigned int addr, unsigned int op, unsigned int p1, unsigned int p2,
+                                   BYTE reg_a, BYTE reg_x, BYTE reg_y,
+                                   BYTE reg_sp, unsigned int reg_st);
 
 /* memmap defines */
 #define MEMMAP_I_O_R 0x80
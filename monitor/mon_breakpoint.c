@@ -69,11 +69,77 @@ typedef struct break_list_s break_list_t;
 static int breakpoint_count;
 break_list_t *breakpoints[NUM_MEMSPACES];
 
+/* For each checkpoint list, a bitmap with one bit set for every address
+   covered by one of its checkpoints.  The checks done for every executed
+   instruction and every watched memory access only look at the list if
+   the bit for the address is set.  NULL while the list is empty.  */
+BYTE *breakpoints_bitmap[NUM_MEMSPACES];
+BYTE *watchpoints_load_bitmap[NUM_MEMSPACES];
+BYTE *watchpoints_store_bitmap[NUM_MEMSPACES];
+
+#define CHECKPOINT_BITMAP_SIZE (0x10000 / 8)
+
 void mon_breakpoint_init(void)
 {
     breakpoint_count = 1;
 }
 
+static BYTE **checkpoint_bitmap_get(break_list_t **head)
+{
+    int i;
+
+    for (i = 0; i < NUM_MEMSPACES; i++) {
+        if (head == &breakpoints[i])
+            return &breakpoints_bitmap[i];
+        if (head == &watchpoints_load[i])
+            return &watchpoints_load_bitmap[i];
+        if (head == &watchpoints_store[i])
+            return &watchpoints_store_bitmap[i];
+    }
+
+    return NULL;
+}
+
+static void checkpoint_bitmap_update(break_list_t **head)
+{
+    BYTE **bitmap;
+    break_list_t *ptr;
+    unsigned int loc, end, count;
+
+    bitmap = checkpoint_bitmap_get(head);
+
+    if (bitmap == NULL)
+        return;
+
+    if (*head == NULL) {
+        lib_free(*bitmap);
+        *bitmap = NULL;
+        return;
+    }
+
+    if (*bitmap == NULL)
+        *bitmap = lib_malloc(CHECKPOINT_BITMAP_SIZE);
+
+    memset(*bitmap, 0, CHECKPOINT_BITMAP_SIZE);
+
+    for (ptr = *head; ptr != NULL; ptr = ptr->next) {
+        /* Same ranges as `mon_is_in_range()', including wrap around.  */
+        loc = addr_location(ptr->brkpt->start_addr) & 0xffff;
+
+        if (mon_is_valid_addr(ptr->brkpt->end_addr))
+            end = addr_location(ptr->brkpt->end_addr) & 0xffff;
+        else
+            end = loc;
+
+        for (count = 0; count < 0x10000; count++) {
+            (*bitmap)[loc >> 3] |= 1 << (loc & 7);
+            if (loc == end)
+                break;
+            loc = (loc + 1) & 0xffff;
+        }
+    }
+}
+
 static void remove_checkpoint_from_list(break_list_t **head, breakpoint_t *bp)
 {
     break_list_t *cur_entry, *prev_entry;
@@ -100,6 +166,8 @@ static void remove_checkpoint_from_list(break_list_t **head, breakpoint_t *bp)
         }
         lib_free(cur_entry);
     }
+
+    checkpoint_bitmap_update(head);
 }
 
 static breakpoint_t *find_checkpoint(int brknum)
@@ -340,6 +408,20 @@ bool monitor_breakpoint_check_checkpoint(MEMSPACE mem, WORD addr,
     bool result = FALSE;
     MON_ADDR temp;
     const char *type;
+    BYTE *bitmap = NULL;
+
+    if (list == NULL)
+        return FALSE;
+
+    if (list == breakpoints[mem])
+        bitmap = breakpoints_bitmap[mem];
+    else if (list == watchpoints_load[mem])
+        bitmap = watchpoints_load_bitmap[mem];
+    else if (list == watchpoints_store[mem])
+        bitmap = watchpoints_store_bitmap[mem];
+
+    if (bitmap != NULL && !checkpoint_bitmap_test(bitmap, addr))
+        return FALSE;
 
     ptr = search_checkpoint_list(list, addr);
 
@@ -418,11 +500,12 @@ static void add_to_checkpoint_list(break_list_t **head, breakpoint_t *bp)
     if (!prev_entry) {
         *head = new_entry;
         new_entry->next = cur_entry;
-        return;
+    } else {
+        prev_entry->next = new_entry;
+        new_entry->next = cur_entry;
     }
 
-    prev_entry->next = new_entry;
-    new_entry->next = cur_entry;
+    checkpoint_bitmap_update(head);
 }
 
 static 
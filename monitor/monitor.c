@@ -55,6 +55,7 @@
 #include "fullscreenarch.h"
 #endif
 
+#include "gfxoutput.h"
 #include "interrupt.h"
 #include "ioutil.h"
 #include "kbdbuf.h"
@@ -741,6 +742,165 @@ int mon_memmap_picx;
 int mon_memmap_picy;
 BYTE memmap_state;
 
+#ifdef FEATURE_CPUMEMHISTORY
+/* Per-frame heatmap: for every address the number of reads, writes,
+   executed opcodes and writes to bytes that have been executed before
+   (self-modifying code) during the current frame, saturating at 0xffff.
+   At the end of a frame only the addresses that were accessed are kept,
+   so the last `MemMapHistoryFrames' frames are stored as sparse lists in
+   a ring.  */
+#define MEMMAP_HISTORY_READ     0
+#define MEMMAP_HISTORY_WRITE    1
+#define MEMMAP_HISTORY_EXEC     2
+#define MEMMAP_HISTORY_SMC      3
+#define MEMMAP_HISTORY_COUNTERS 4
+
+#define MEMMAP_HISTORY_MAGIC "VICEHEATMAP"
+#define MEMMAP_HISTORY_VERSION 2
+
+typedef struct memmap_history_entry_s {
+    unsigned int addr;
+    WORD count[MEMMAP_HISTORY_COUNTERS];
+} memmap_history_entry_t;
+
+typedef struct memmap_history_frame_s {
+    unsigned int num;
+    memmap_history_entry_t *entries;
+} memmap_history_frame_t;
+
+/* Counters of the current frame and the addresses they are set for.  */
+static WORD *memmap_frame = NULL;
+static unsigned int *memmap_touched = NULL;
+static unsigned int memmap_touched_num;
+
+static memmap_history_frame_t *memmap_history = NULL;
+static unsigned int memmap_history_pos;
+static unsigned int memmap_history_used;
+static int memmap_history_frames = 0;
+static char *memmap_history_file_name = NULL;
+
+static void memmap_history_clear(void)
+{
+    int i;
+
+    for (i = 0; i < memmap_history_frames; i++) {
+        lib_free(memmap_history[i].entries);
+        memmap_history[i].entries = NULL;
+        memmap_history[i].num = 0;
+    }
+    memmap_history_pos = 0;
+    memmap_history_used = 0;
+}
+
+static void memmap_history_free(void)
+{
+    if (memmap_history != NULL)
+        memmap_history_clear();
+
+    lib_free(memmap_frame);
+    lib_free(memmap_touched);
+    lib_free(memmap_history);
+    memmap_frame = NULL;
+    memmap_touched = NULL;
+    memmap_history = NULL;
+}
+
+static void memmap_history_alloc(void)
+{
+    memmap_history_free();
+
+    if (memmap_history_frames <= 0 || mon_memmap == NULL)
+        return;
+
+    memmap_frame = lib_calloc((size_t)mon_memmap_size * MEMMAP_HISTORY_COUNTERS,
+                              sizeof(WORD));
+    memmap_touched = lib_malloc((size_t)mon_memmap_size
+                                * sizeof(unsigned int));
+    memmap_touched_num = 0;
+    memmap_history = lib_calloc(memmap_history_frames,
+                                sizeof(memmap_history_frame_t));
+    memmap_history_pos = 0;
+    memmap_history_used = 0;
+}
+
+static void memmap_history_count(unsigned int addr, unsigned int type)
+{
+    WORD *counter;
+
+    counter = &memmap_frame[addr * MEMMAP_HISTORY_COUNTERS];
+
+    /* The self-modifying write counter only moves with the write one.  */
+    if (counter[MEMMAP_HISTORY_READ] == 0 && counter[MEMMAP_HISTORY_WRITE] == 0
+        && counter[MEMMAP_HISTORY_EXEC] == 0)
+        memmap_touched[memmap_touched_num++] = addr;
+
+    if (type & (MEMMAP_RAM_X | MEMMAP_ROM_X)) {
+        counter += MEMMAP_HISTORY_EXEC;
+    } else if (type & (MEMMAP_RAM_W | MEMMAP_ROM_W | MEMMAP_I_O_W)) {
+        if ((mon_memmap[addr] & MEMMAP_RAM_X)
+            && counter[MEMMAP_HISTORY_SMC] != 0xffff)
+            counter[MEMMAP_HISTORY_SMC]++;
+        counter += MEMMAP_HISTORY_WRITE;
+    } else {
+        counter += MEMMAP_HISTORY_READ;
+    }
+
+    if (*counter != 0xffff)
+        (*counter)++;
+}
+
+static int memmap_history_entry_compare(const void *a, const void *b)
+{
+    const memmap_history_entry_t *entry_a = a, *entry_b = b;
+
+    if (entry_a->addr < entry_b->addr)
+        return -1;
+
+    return (entry_a->addr > entry_b->addr) ? 1 : 0;
+}
+#endif
+
+/* Called at the end of every frame.  */
+void monitor_memmap_frame(void)
+{
+#ifdef FEATURE_CPUMEMHISTORY
+    memmap_history_frame_t *frame;
+    WORD *counter;
+    unsigned int i;
+
+    if (memmap_frame == NULL)
+        return;
+
+    frame = &memmap_history[memmap_history_pos];
+
+    lib_free(frame->entries);
+    frame->entries = NULL;
+    frame->num = memmap_touched_num;
+
+    if (memmap_touched_num > 0)
+        frame->entries = lib_malloc(memmap_touched_num
+                                    * sizeof(memmap_history_entry_t));
+
+    for (i = 0; i < memmap_touched_num; i++) {
+        counter = &memmap_frame[memmap_touched[i] * MEMMAP_HISTORY_COUNTERS];
+        frame->entries[i].addr = memmap_touched[i];
+        memcpy(frame->entries[i].count, counter,
+               MEMMAP_HISTORY_COUNTERS * sizeof(WORD));
+        memset(counter, 0, MEMMAP_HISTORY_COUNTERS * sizeof(WORD));
+    }
+    memmap_touched_num = 0;
+
+    if (frame->num > 1)
+        qsort(frame->entries, frame->num, sizeof(memmap_history_entry_t),
+              memmap_history_entry_compare);
+
+    if (++memmap_history_pos == (unsigned int)memmap_history_frames)
+        memmap_history_pos = 0;
+    if (memmap_history_used < (unsigned int)memmap_history_frames)
+        memmap_history_used++;
+#endif
+}
+
 static void mon_memmap_init(void)
 {
 #ifdef FEATURE_CPUMEMHISTORY
@@ -752,6 +912,7 @@ static void mon_memmap_init(void)
     }
     mon_memmap_size = mon_memmap_picx * mon_memmap_picy;
     mon_memmap = lib_malloc(mon_memmap_size);
+    memmap_history_alloc();
 #else
     mon_memmap = NULL;
     mon_memmap_size = 0;
@@ -764,6 +925,12 @@ void mon_memmap_zap(void)
 {
 #ifdef FEATURE_CPUMEMHISTORY
     memset(mon_memmap, 0, mon_memmap_size);
+    if (memmap_frame != NULL) {
+        memset(memmap_frame, 0, (size_t)mon_memmap_size
+               * MEMMAP_HISTORY_COUNTERS * sizeof(WORD));
+        memmap_touched_num = 0;
+        memmap_history_clear();
+    }
 #else
     mon_out("Disabled. configure with --enable-memmap and recompile.\n");
 #endif
@@ -829,7 +996,14 @@ void monitor_memmap_store(unsigned int addr, unsigned int type)
       ||((op == OP_RTS) && ((addr>0x1ff)||(addr<0x100)))))
         return;
 
-    mon_memmap[addr & (mon_memmap_size-1)] |= type;
+    addr &= (mon_memmap_size-1);
+
+#ifdef FEATURE_CPUMEMHISTORY
+    if (memmap_frame != NULL && type != 0)
+        memmap_history_count(addr, type);
+#endif
+
+    mon_memmap[addr] |= type;
 }
 
 #ifdef FEATURE_CPUMEMHISTORY
@@ -876,6 +1050,179 @@ void mon_memmap_save(const char* filename, int format)
 #endif
 }
 
+#ifdef FEATURE_CPUMEMHISTORY
+/* Map a counter to 0..`max' on a logarithmic scale.  */
+static BYTE memmap_history_level(WORD count, int max)
+{
+    int bits = 0;
+
+    while (count != 0) {
+        bits++;
+        count >>= 1;
+    }
+
+    return (BYTE)((bits * max + 15) / 16);
+}
+
+/* Write the heatmap as a picture strip, one line per frame and one pixel
+   per 256 byte page: red is writes (full red for self-modifying code),
+   green is execution and blue is reads.  */
+static int memmap_history_save_strip(const char *drvname, const char *filename)
+{
+    BYTE palette[256 * 3];
+    BYTE *gfx, *dst;
+    WORD *page_counter;
+    memmap_history_frame_t *frame;
+    memmap_history_entry_t *entry;
+    unsigned int pages, frame_nr, page, i, j, n, sum;
+    int result;
+
+    for (i = 0; i < 256; i++) {
+        palette[i * 3 + 0] = (BYTE)(((i >> 5) & 7) * 255 / 7);
+        palette[i * 3 + 1] = (BYTE)(((i >> 2) & 7) * 255 / 7);
+        palette[i * 3 + 2] = (BYTE)((i & 3) * 255 / 3);
+    }
+
+    pages = (unsigned int)mon_memmap_size >> 8;
+    page_counter = lib_malloc(pages * MEMMAP_HISTORY_COUNTERS * sizeof(WORD));
+    gfx = lib_malloc(pages * memmap_history_used);
+    dst = gfx;
+
+    n = (memmap_history_pos + memmap_history_frames - memmap_history_used)
+        % memmap_history_frames;
+
+    for (frame_nr = 0; frame_nr < memmap_history_used; frame_nr++) {
+        frame = &memmap_history[n];
+        memset(page_counter, 0, pages * MEMMAP_HISTORY_COUNTERS * sizeof(WORD));
+        for (i = 0; i < frame->num; i++) {
+            entry = &frame->entries[i];
+            for (j = 0; j < MEMMAP_HISTORY_COUNTERS; j++) {
+                sum = page_counter[(entry->addr >> 8) * MEMMAP_HISTORY_COUNTERS
+                                   + j] + entry->count[j];
+                page_counter[(entry->addr >> 8) * MEMMAP_HISTORY_COUNTERS + j]
+                    = (WORD)((sum > 0xffff) ? 0xffff : sum);
+            }
+        }
+        for (page = 0; page < pages; page++) {
+            WORD *counter = &page_counter[page * MEMMAP_HISTORY_COUNTERS];
+            BYTE red;
+
+            red = counter[MEMMAP_HISTORY_SMC]
+                  ? 7 : memmap_history_level(counter[MEMMAP_HISTORY_WRITE], 7);
+            *dst++ = (BYTE)((red << 5)
+                     | (memmap_history_level(counter[MEMMAP_HISTORY_EXEC], 7) << 2)
+                     | memmap_history_level(counter[MEMMAP_HISTORY_READ], 3));
+        }
+        n = (n + 1) % memmap_history_frames;
+    }
+
+    result = memmap_screenshot_save(drvname, filename, pages,
+                                    memmap_history_used, gfx, palette);
+
+    lib_free(gfx);
+    lib_free(page_counter);
+
+    return result;
+}
+
+static int memmap_history_save_binary(const char *filename)
+{
+    FILE *fd;
+    BYTE header[28];
+    BYTE entry_buf[4 + MEMMAP_HISTORY_COUNTERS * 2];
+    memmap_history_frame_t *frame;
+    memmap_history_entry_t *entry;
+    unsigned int frame_nr, i, j, n;
+
+    fd = fopen(filename, MODE_WRITE);
+
+    if (fd == NULL)
+        return -1;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, MEMMAP_HISTORY_MAGIC, strlen(MEMMAP_HISTORY_MAGIC));
+    header[12] = MEMMAP_HISTORY_VERSION;
+    util_dword_to_le_buf(&header[16], (DWORD)mon_memmap_size);
+    util_dword_to_le_buf(&header[20], MEMMAP_HISTORY_COUNTERS);
+    util_dword_to_le_buf(&header[24], memmap_history_used);
+
+    if (fwrite(header, sizeof(header), 1, fd) != 1) {
+        fclose(fd);
+        return -1;
+    }
+
+    n = (memmap_history_pos + memmap_history_frames - memmap_history_used)
+        % memmap_history_frames;
+
+    for (frame_nr = 0; frame_nr < memmap_history_used; frame_nr++) {
+        frame = &memmap_history[n];
+        util_dword_to_le_buf(entry_buf, frame->num);
+        if (fwrite(entry_buf, 4, 1, fd) != 1) {
+            fclose(fd);
+            return -1;
+        }
+        for (i = 0; i < frame->num; i++) {
+            entry = &frame->entries[i];
+            util_dword_to_le_buf(entry_buf, entry->addr);
+            for (j = 0; j < MEMMAP_HISTORY_COUNTERS; j++)
+                util_word_to_le_buf(&entry_buf[4 + j * 2], entry->count[j]);
+            if (fwrite(entry_buf, sizeof(entry_buf), 1, fd) != 1) {
+                fclose(fd);
+                return -1;
+            }
+        }
+        n = (n + 1) % memmap_history_frames;
+    }
+
+    fclose(fd);
+
+    return 0;
+}
+#endif
+
+/* Save the per-frame heatmap.  If the extension of `filename' belongs to
+   one of the graphics output drivers, a picture strip is written;
+   otherwise a binary file with a 28 byte header ("VICEHEATMAP", version,
+   size of the address space, counters per address and frames as DWORDs
+   at offset 16).  The frames follow oldest first, each as a DWORD entry
+   count and the accessed addresses in ascending order: the address as a
+   DWORD, then the read, write, exec and self-modifying write counters as
+   WORDs.  */
+int mon_memmap_history_save(const char *filename)
+{
+#ifdef FEATURE_CPUMEMHISTORY
+    gfxoutputdrv_t *drv = NULL;
+    char *ext;
+    int result = -1;
+
+    if (memmap_frame == NULL || memmap_history_used == 0)
+        return -1;
+
+    ext = util_get_extension((char *)filename);
+
+    if (ext != NULL) {
+        for (drv = gfxoutput_drivers_iter_init(); drv != NULL;
+             drv = gfxoutput_drivers_iter_next()) {
+            if (drv->default_extension != NULL && drv->savememmap != NULL
+                && strcasecmp(ext, drv->default_extension) == 0) {
+                result = memmap_history_save_strip(drv->name, filename);
+                break;
+            }
+        }
+    }
+
+    if (ext == NULL || drv == NULL)
+        result = memmap_history_save_binary(filename);
+
+    if (result < 0)
+        log_error(LOG_DEFAULT, "Cannot write memory heatmap `%s'.", filename);
+
+    return result;
+#else
+    return -1;
+#endif
+}
+
 void mon_screenshot_save(const char* filename, int format)
 {
     const char* drvname;
@@ -1182,6 +1529,11 @@ void monitor_shutdown(void)
     }
 
 #ifdef FEATURE_CPUMEMHISTORY                                                                                                                                                                         
+   if (memmap_history_file_name != NULL && *memmap_history_file_name != '\0')
+       mon_memmap_history_save(memmap_history_file_name);
+   memmap_history_free();
+   lib_free(memmap_history_file_name);
+   memmap_history_file_name = NULL;
    lib_free(mon_memmap);                                                                                                                                                                            
 #endif
 }
@@ -1211,6 +1563,56 @@ static const cmdline_option_t cmdline_options[] = {
     { NULL }
 };
 
+#ifdef FEATURE_CPUMEMHISTORY
+static int set_memmap_history_frames(int val, void *param)
+{
+    if (val < 0)
+        return -1;
+
+    memmap_history_frames = val;
+    memmap_history_alloc();
+
+    return 0;
+}
+
+/* Setting the name writes the heatmap recorded so far; it is written
+   there again on exit.  */
+static int set_memmap_history_file_name(const char *val, void *param)
+{
+    util_string_set(&memmap_history_file_name, val);
+
+    if (memmap_history_file_name != NULL && *memmap_history_file_name != '\0'
+        && memmap_history_used > 0)
+        mon_memmap_history_save(memmap_history_file_name);
+
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "MemMapHistoryFile", "", RES_EVENT_NO, NULL,
+      &memmap_history_file_name, set_memmap_history_file_name, NULL },
+    { NULL }
+};
+
+static const resource_int_t resources_int[] = {
+    { "MemMapHistoryFrames", 0, RES_EVENT_NO, NULL,
+      &memmap_history_frames, set_memmap_history_frames, NULL },
+    { NULL }
+};
+#endif
+
+int monitor_resources_init(void)
+{
+#ifdef FEATURE_CPUMEMHISTORY
+    if (resources_register_string(resources_string) < 0)
+        return -1;
+
+    return resources_register_int(resources_int);
+#else
+    return 0;
+#endif
+}
+
 int monitor_cmdline_options_init(void)
 {
     mon_cart_cmd.cartridge_attach_image = NULL;
@@ -1830,6 +2232,10 @@ void monitor_watch_push_load_addr(WORD addr, MEMSPACE mem)
     if (inside_monitor)
         return;
 
+    if (watchpoints_load_bitmap[mem] == NULL
+        || !checkpoint_bitmap_test(watchpoints_load_bitmap[mem], addr))
+        return;
+
     if (watch_load_count[mem] == 9)
          return;
 
@@ -1843,6 +2249,10 @@ void monitor_watch_push_store_addr(WORD addr, MEMSPACE mem)
     if (inside_monitor)
         return;
 
+    if (watchpoints_store_bitmap[mem] == NULL
+        || !checkpoint_bitmap_test(watchpoints_store_bitmap[mem], addr))
+        return;
+
     if (watch_store_count[mem] == 9)
         return;
 
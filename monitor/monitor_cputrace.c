@@ -0,0 +1,504 @@
+/*
+ * monitor_cputrace.c - Compact trace of the main CPU instructions.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Unlike the 64-entry `cpuhistory', this records every instruction of the
+   main CPU into a ring buffer of `CPUTraceSize' KB which is allocated once.
+   Each instruction is stored as the difference to the previous one, which
+   usually takes 2-4 bytes:
+
+     BYTE flags
+     BYTE PC delta        if CPUTRACE_PC_REL (signed)
+     WORD PC              if CPUTRACE_PC_ABS
+                          (neither: PC follows the previous instruction)
+     BYTE opcode, p1, p2  if CPUTRACE_CODE
+                          (else the same as last time at this PC)
+     BYTE A, X, Y, ST     each if its flag is set
+     BYTE ext             if CPUTRACE_EXT
+     BYTE SP              if CPUTRACE_EXT_SP
+     BYTE bank            if CPUTRACE_EXT_BANK
+     BYTE cycles          cycles since the previous instruction, 0xff
+                          means a DWORD with the real number follows
+
+   The ring is split into blocks; each block starts with a full record, so
+   dropping the oldest block when the ring wraps never breaks decoding of
+   the others.  The file written by `monitor_cputrace_save()' has:
+
+     "VICECPUTRACE", BYTE version, 3 BYTEs reserved
+     DWORD number of blocks
+     256 BYTEs instruction length table used for the PC prediction
+     per block, oldest first:
+       DWORD clock of the first instruction
+       DWORD number of instructions
+       DWORD number of data bytes, followed by the data
+
+   All numbers are little endian.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "clkguard.h"
+#include "cmdline.h"
+#include "lib.h"
+#include "log.h"
+#include "maincpu.h"
+#include "mem.h"
+#include "monitor.h"
+#include "monitor_cputrace.h"
+#include "resources.h"
+#include "translate.h"
+#include "types.h"
+#include "util.h"
+
+
+#define CPUTRACE_MAGIC "VICECPUTRACE"
+#define CPUTRACE_VERSION 1
+
+#define CPUTRACE_BLOCK_SIZE 0x10000
+
+/* Longest possible record.  */
+#define CPUTRACE_RECORD_MAX 20
+
+#define CPUTRACE_PC_REL   0x01
+#define CPUTRACE_PC_ABS   0x02
+#define CPUTRACE_CODE     0x04
+#define CPUTRACE_A        0x08
+#define CPUTRACE_X        0x10
+#define CPUTRACE_Y        0x20
+#define CPUTRACE_ST       0x40
+#define CPUTRACE_EXT      0x80
+
+#define CPUTRACE_EXT_SP   0x01
+#define CPUTRACE_EXT_BANK 0x02
+
+typedef struct cputrace_block_s {
+    DWORD start_clk;
+    DWORD count;
+    DWORD len;
+} cputrace_block_t;
+
+/* Instruction length by opcode, including the undocumented ones.  */
+static const BYTE cputrace_opcode_length[256] = {
+    1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $00 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $10 */
+    3, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $20 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $30 */
+    1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $40 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $50 */
+    1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $60 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $70 */
+    2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $80 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $90 */
+    2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $a0 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $b0 */
+    2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $c0 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,  /* $d0 */
+    2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,  /* $e0 */
+    2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3   /* $f0 */
+};
+
+int monitor_cputrace_enabled = 0;
+
+static log_t cputrace_log = LOG_ERR;
+
+static int cputrace_size;
+static char *cputrace_file_name = NULL;
+
+static BYTE *trace_buffer = NULL;
+static cputrace_block_t *trace_blocks = NULL;
+static unsigned int trace_num_blocks;
+static unsigned int trace_block;
+static unsigned int trace_used_blocks;
+static BYTE *trace_ptr;
+static BYTE *trace_limit;
+static int trace_keyframe;
+
+/* Opcode and operands last seen at each address, tagged with the block
+   generation so that each block only refers to its own records.  */
+static DWORD *trace_code = NULL;
+static BYTE trace_gen;
+
+static WORD last_pc;
+static BYTE last_op, last_a, last_x, last_y, last_sp, last_st, last_bank;
+static CLOCK last_clk;
+static read_func_ptr_t *last_read_tab;
+
+static int (*cputrace_bank_func)(void) = NULL;
+static int clk_guard_registered = 0;
+
+/* ------------------------------------------------------------------------- */
+
+static void cputrace_clk_overflow_callback(CLOCK sub, void *data)
+{
+    last_clk -= sub;
+}
+
+static void cputrace_next_block(void)
+{
+    cputrace_block_t *block;
+
+    if (!clk_guard_registered && maincpu_clk_guard != NULL) {
+        clk_guard_add_callback(maincpu_clk_guard,
+                               cputrace_clk_overflow_callback, NULL);
+        clk_guard_registered = 1;
+    }
+
+    if (trace_used_blocks > 0)
+        trace_block = (trace_block + 1) % trace_num_blocks;
+    if (trace_used_blocks < trace_num_blocks)
+        trace_used_blocks++;
+
+    block = &trace_blocks[trace_block];
+    block->start_clk = (DWORD)maincpu_clk;
+    block->count = 0;
+    block->len = 0;
+
+    trace_ptr = trace_buffer + trace_block * CPUTRACE_BLOCK_SIZE;
+    trace_limit = trace_ptr + CPUTRACE_BLOCK_SIZE - CPUTRACE_RECORD_MAX;
+
+    if (++trace_gen == 0) {
+        memset(trace_code, 0, 0x10000 * sizeof(DWORD));
+        trace_gen = 1;
+    }
+
+    trace_keyframe = 1;
+}
+
+void monitor_cputrace_store(unsigned int addr, unsigned int op,
+                            unsigned int p1, unsigned int p2,
+                            BYTE reg_a, BYTE reg_x, BYTE reg_y,
+                            BYTE reg_sp, unsigned int reg_st)
+{
+    BYTE *p, flags = 0, ext = 0;
+    DWORD code, cycles;
+    WORD pc, delta;
+    BYTE st = (BYTE)reg_st, bank;
+
+    if (trace_ptr >= trace_limit)
+        cputrace_next_block();
+
+    pc = (WORD)addr;
+    p = trace_ptr + 1;
+
+    if (trace_keyframe) {
+        flags = CPUTRACE_PC_ABS | CPUTRACE_A | CPUTRACE_X | CPUTRACE_Y
+                | CPUTRACE_ST | CPUTRACE_EXT;
+        ext = CPUTRACE_EXT_SP | CPUTRACE_EXT_BANK;
+        last_clk = maincpu_clk;
+        last_read_tab = NULL;
+    } else {
+        if (pc != (WORD)(last_pc + cputrace_opcode_length[last_op])) {
+            delta = (WORD)(pc - last_pc);
+            if (delta < 0x80 || delta >= 0xff80)
+                flags |= CPUTRACE_PC_REL;
+            else
+                flags |= CPUTRACE_PC_ABS;
+        }
+        if (reg_a != last_a)
+            flags |= CPUTRACE_A;
+        if (reg_x != last_x)
+            flags |= CPUTRACE_X;
+        if (reg_y != last_y)
+            flags |= CPUTRACE_Y;
+        if (st != last_st)
+            flags |= CPUTRACE_ST;
+        if (reg_sp != last_sp)
+            ext |= CPUTRACE_EXT_SP;
+    }
+
+    if (_mem_read_tab_ptr != last_read_tab) {
+        last_read_tab = _mem_read_tab_ptr;
+        bank = cputrace_bank_func != NULL ? (BYTE)cputrace_bank_func() : 0;
+        if (bank != last_bank || trace_keyframe)
+            ext |= CPUTRACE_EXT_BANK;
+        last_bank = bank;
+    }
+    if (ext)
+        flags |= CPUTRACE_EXT;
+
+    if (flags & CPUTRACE_PC_REL) {
+        *p++ = (BYTE)(pc - last_pc);
+    } else if (flags & CPUTRACE_PC_ABS) {
+        *p++ = (BYTE)(pc & 0xff);
+        *p++ = (BYTE)(pc >> 8);
+    }
+
+    code = (op & 0xff) | ((p1 & 0xff) << 8) | ((p2 & 0xff) << 16)
+           | ((DWORD)trace_gen << 24);
+    if (trace_code[pc] != code) {
+        trace_code[pc] = code;
+        flags |= CPUTRACE_CODE;
+        *p++ = (BYTE)op;
+        *p++ = (BYTE)p1;
+        *p++ = (BYTE)p2;
+    }
+
+    if (flags & CPUTRACE_A)
+        *p++ = reg_a;
+    if (flags & CPUTRACE_X)
+        *p++ = reg_x;
+    if (flags & CPUTRACE_Y)
+        *p++ = reg_y;
+    if (flags & CPUTRACE_ST)
+        *p++ = st;
+    if (flags & CPUTRACE_EXT) {
+        *p++ = ext;
+        if (ext & CPUTRACE_EXT_SP)
+            *p++ = reg_sp;
+        if (ext & CPUTRACE_EXT_BANK)
+            *p++ = last_bank;
+    }
+
+    cycles = (DWORD)(maincpu_clk - last_clk);
+    if (cycles < 0xff) {
+        *p++ = (BYTE)cycles;
+    } else {
+        *p++ = 0xff;
+        *p++ = (BYTE)(cycles & 0xff);
+        *p++ = (BYTE)((cycles >> 8) & 0xff);
+        *p++ = (BYTE)((cycles >> 16) & 0xff);
+        *p++ = (BYTE)(cycles >> 24);
+    }
+
+    *trace_ptr = flags;
+    trace_blocks[trace_block].len += (DWORD)(p - trace_ptr);
+    trace_blocks[trace_block].count++;
+    trace_ptr = p;
+
+    trace_keyframe = 0;
+    last_pc = pc;
+    last_op = (BYTE)op;
+    last_a = reg_a;
+    last_x = reg_x;
+    last_y = reg_y;
+    last_sp = reg_sp;
+    last_st = st;
+    last_clk = maincpu_clk;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int cputrace_write_dword(FILE *fd, DWORD val)
+{
+    BYTE buf[4];
+
+    buf[0] = (BYTE)(val & 0xff);
+    buf[1] = (BYTE)((val >> 8) & 0xff);
+    buf[2] = (BYTE)((val >> 16) & 0xff);
+    buf[3] = (BYTE)(val >> 24);
+
+    return fwrite(buf, 4, 1, fd) == 1 ? 0 : -1;
+}
+
+int monitor_cputrace_save(const char *filename)
+{
+    FILE *fd;
+    unsigned int i, n;
+    cputrace_block_t *block;
+    BYTE header[16];
+
+    if (trace_buffer == NULL) {
+        log_error(cputrace_log, "CPU trace is not enabled.");
+        return -1;
+    }
+
+    fd = fopen(filename, MODE_WRITE);
+
+    if (fd == NULL) {
+        log_error(cputrace_log, "Cannot write `%s'.", filename);
+        return -1;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, CPUTRACE_MAGIC, strlen(CPUTRACE_MAGIC));
+    header[12] = CPUTRACE_VERSION;
+
+    if (fwrite(header, sizeof(header), 1, fd) != 1
+        || cputrace_write_dword(fd, trace_used_blocks) < 0
+        || fwrite(cputrace_opcode_length, 256, 1, fd) != 1)
+        goto fail;
+
+    /* Once the ring has wrapped, the oldest block is the one after the
+       current one.  */
+    n = (trace_block + trace_num_blocks + 1 - trace_used_blocks)
+        % trace_num_blocks;
+
+    for (i = 0; i < trace_used_blocks; i++) {
+        block = &trace_blocks[n];
+        if (cputrace_write_dword(fd, block->start_clk) < 0
+            || cputrace_write_dword(fd, block->count) < 0
+            || cputrace_write_dword(fd, block->len) < 0
+            || (block->len > 0
+            && fwrite(trace_buffer + n * CPUTRACE_BLOCK_SIZE, block->len, 1,
+                      fd) != 1))
+            goto fail;
+        n = (n + 1) % trace_num_blocks;
+    }
+
+    fclose(fd);
+
+    log_message(cputrace_log, "CPU trace saved to `%s'.", filename);
+
+    return 0;
+
+fail:
+    fclose(fd);
+    log_error(cputrace_log, "Error writing `%s'.", filename);
+    return -1;
+}
+
+void monitor_cputrace_clear(void)
+{
+    if (trace_buffer == NULL)
+        return;
+
+    trace_block = 0;
+    trace_used_blocks = 0;
+    trace_gen = 0;
+    memset(trace_code, 0, 0x10000 * sizeof(DWORD));
+
+    cputrace_next_block();
+}
+
+void monitor_cputrace_set_bank_func(int (*func)(void))
+{
+    cputrace_bank_func = func;
+}
+
+static void cputrace_free(void)
+{
+    monitor_cputrace_enabled = 0;
+
+    lib_free(trace_buffer);
+    lib_free(trace_blocks);
+    lib_free(trace_code);
+    trace_buffer = NULL;
+    trace_blocks = NULL;
+    trace_code = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int set_cputrace_size(int val, void *param)
+{
+    unsigned int num_blocks;
+
+    if (val < 0)
+        return -1;
+
+    if (val == cputrace_size && (val == 0 || trace_buffer != NULL))
+        return 0;
+
+    cputrace_free();
+
+    cputrace_size = val;
+
+    if (val == 0)
+        return 0;
+
+    if (cputrace_log == LOG_ERR)
+        cputrace_log = log_open("CPU Trace");
+
+    num_blocks = (unsigned int)val / (CPUTRACE_BLOCK_SIZE / 1024);
+    if (num_blocks < 2)
+        num_blocks = 2;
+
+    trace_buffer = lib_malloc(num_blocks * CPUTRACE_BLOCK_SIZE);
+    trace_blocks = lib_calloc(num_blocks, sizeof(cputrace_block_t));
+    trace_code = lib_malloc(0x10000 * sizeof(DWORD));
+    trace_num_blocks = num_blocks;
+
+    monitor_cputrace_clear();
+
+    monitor_cputrace_enabled = 1;
+
+    return 0;
+}
+
+static int set_cputrace_file_name(const char *val, void *param)
+{
+    util_string_set(&cputrace_file_name, val);
+
+    /* Setting the name while tracing writes out what we have so far; the
+       trace is written there again on exit.  */
+    if (trace_buffer != NULL && cputrace_file_name != NULL
+        && *cputrace_file_name != '\0')
+        monitor_cputrace_save(cputrace_file_name);
+
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "CPUTraceFile", "", RES_EVENT_NO, NULL,
+      &cputrace_file_name, set_cputrace_file_name, NULL },
+    { NULL }
+};
+
+static const resource_int_t resources_int[] = {
+    { "CPUTraceSize", 0, RES_EVENT_NO, NULL,
+      &cputrace_size, set_cputrace_size, NULL },
+    { NULL }
+};
+
+int monitor_cputrace_resources_init(void)
+{
+    if (resources_register_string(resources_string) < 0)
+        return -1;
+
+    return resources_register_int(resources_int);
+}
+
+void monitor_cputrace_resources_shutdown(void)
+{
+    if (trace_buffer != NULL && cputrace_file_name != NULL
+        && *cputrace_file_name != '\0')
+        monitor_cputrace_save(cputrace_file_name);
+
+    cputrace_free();
+    lib_free(cputrace_file_name);
+    cputrace_file_name = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-cputracesize", SET_RESOURCE, 1,
+      NULL, NULL, "CPUTraceSize", NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<size in KB>"), T_("Record the main CPU instructions into a trace buffer of this size (0 = off)") },
+    { "-cputracefile", SET_RESOURCE, 1,
+      NULL, NULL, "CPUTraceFile", NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<name>"), T_("Write the CPU trace to this file on exit") },
+    { NULL }
+};
+
+int monitor_cputrace_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
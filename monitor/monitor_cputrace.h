@@ -0,0 +1,38 @@
+/*
+ * monitor_cputrace.h - Compact trace of the main CPU instructions.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_MONITOR_CPUTRACE_H
+#define VICE_MONITOR_CPUTRACE_H
+
+extern int monitor_cputrace_resources_init(void);
+extern void monitor_cputrace_resources_shutdown(void);
+extern int monitor_cputrace_cmdline_options_init(void);
+
+extern int monitor_cputrace_save(const char *filename);
+extern void monitor_cputrace_clear(void);
+
+/* Returns the memory configuration of the machine, recorded with the
+   trace whenever the CPU memory tables are switched.  */
+extern void monitor_cputrace_set_bank_func(int (*func)(void));
+
+#endif
@@ -33,11 +33,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "archdep.h"
 #include "cmdline.h"
+#include "ioutil.h"
 #include "lib.h"
 #include "log.h"
+#include "machine.h"
+#include "mon_breakpoint.h"
+#include "mon_register.h"
 #include "monitor.h"
 #include "monitor_network.h"
+#include "montypes.h"
 #include "resources.h"
 #include "translate.h"
 #include "uiapi.h"
@@ -122,21 +128,432 @@ void monitor_check_remote(void)
     }
 }
 
+/* ------------------------------------------------------------------------- */
+
+/* Binary protocol.
+
+   Instead of a text command line, a client may send a binary request:
+   STX (0x02), the length of the body as a 32 bit little endian number,
+   and the body, a sequence of operations of the form
+
+     BYTE   command (MON_BINARY_*)
+     DWORD  length of the parameters
+     ...    parameters
+
+   All operations of a request are executed in order, and answered with a
+   single response with the same framing, holding one result per operation:
+
+     BYTE   command
+     BYTE   error code (MON_BINARY_ERR_*)
+     DWORD  length of the result
+     ...    result
+
+   Words are little endian.  Memory spaces are numbered like MEMSPACE.
+   Text output of the monitor is still sent between responses; clients
+   skip anything up to the next STX.
+
+   MEM_GET           BYTE memspace, WORD start, WORD end -> the bytes
+   MEM_SET           BYTE memspace, WORD start, the bytes
+   REGS_GET          BYTE memspace -> per register: BYTE name length,
+                     name, BYTE size in bits, DWORD value
+   REG_SET           BYTE memspace, BYTE name length, name, DWORD value
+   CHECKPOINT_SET    BYTE memspace, WORD start, WORD end, BYTE flags
+                     (MON_BINARY_CP_*) -> DWORD checkpoint number
+   CHECKPOINT_DELETE DWORD checkpoint number
+   STEP              WORD count, BYTE non-zero to step over subroutines
+   CONTINUE          (no parameters)
+   SNAPSHOT_SAVE     (no parameters) -> the snapshot
+   SNAPSHOT_LOAD     the snapshot
+
+   STEP and CONTINUE leave the monitor once the whole request has been
+   answered.  */
+
+#define MON_BINARY_STX                  0x02
+
+#define MON_BINARY_MEM_GET              0x01
+#define MON_BINARY_MEM_SET              0x02
+#define MON_BINARY_REGS_GET             0x03
+#define MON_BINARY_REG_SET              0x04
+#define MON_BINARY_CHECKPOINT_SET       0x05
+#define MON_BINARY_CHECKPOINT_DELETE    0x06
+#define MON_BINARY_STEP                 0x07
+#define MON_BINARY_CONTINUE             0x08
+#define MON_BINARY_SNAPSHOT_SAVE        0x09
+#define MON_BINARY_SNAPSHOT_LOAD        0x0a
+
+#define MON_BINARY_ERR_OK               0x00
+#define MON_BINARY_ERR_LENGTH           0x01
+#define MON_BINARY_ERR_MEMSPACE         0x02
+#define MON_BINARY_ERR_PARAMETER        0x03
+#define MON_BINARY_ERR_COMMAND          0x04
+#define MON_BINARY_ERR_FAILED           0x05
+
+#define MON_BINARY_CP_LOAD              0x01
+#define MON_BINARY_CP_STORE             0x02
+#define MON_BINARY_CP_TEMPORARY         0x04
+#define MON_BINARY_CP_TRACE             0x08
+
+/* Longest text command line and binary request accepted.  */
+#define MONITOR_NETWORK_LINE_MAX        200
+#define MONITOR_NETWORK_REQUEST_MAX     0x1000000
+
+typedef struct mon_binary_buffer_s {
+    BYTE *data;
+    size_t len;
+    size_t size;
+} mon_binary_buffer_t;
+
+static void mon_binary_put(mon_binary_buffer_t *buf, const BYTE *data,
+                           size_t len)
+{
+    if (buf->len + len > buf->size) {
+        buf->size = (buf->len + len) * 2;
+        buf->data = lib_realloc(buf->data, buf->size);
+    }
+    if (data != NULL)
+        memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void mon_binary_put_byte(mon_binary_buffer_t *buf, BYTE val)
+{
+    mon_binary_put(buf, &val, 1);
+}
+
+static void mon_binary_put_dword(mon_binary_buffer_t *buf, DWORD val)
+{
+    BYTE data[4];
+
+    data[0] = (BYTE)(val & 0xff);
+    data[1] = (BYTE)((val >> 8) & 0xff);
+    data[2] = (BYTE)((val >> 16) & 0xff);
+    data[3] = (BYTE)(val >> 24);
+    mon_binary_put(buf, data, 4);
+}
+
+static void mon_binary_set_dword(BYTE *p, DWORD val)
+{
+    p[0] = (BYTE)(val & 0xff);
+    p[1] = (BYTE)((val >> 8) & 0xff);
+    p[2] = (BYTE)((val >> 16) & 0xff);
+    p[3] = (BYTE)(val >> 24);
+}
+
+static WORD mon_binary_get_word(const BYTE *p)
+{
+    return (WORD)(p[0] | (p[1] << 8));
+}
+
+static DWORD mon_binary_get_dword(const BYTE *p)
+{
+    return (DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16)
+           | ((DWORD)p[3] << 24);
+}
+
+static int mon_binary_memspace_ok(BYTE mem)
+{
+    return mem >= FIRST_SPACE && mem <= LAST_SPACE
+           && monitor_cpu_for_memspace[mem] != NULL;
+}
+
+static int mon_binary_mem_get(const BYTE *param, DWORD len,
+                              mon_binary_buffer_t *out)
+{
+    unsigned int addr, end;
+
+    if (len != 5)
+        return MON_BINARY_ERR_LENGTH;
+    if (!mon_binary_memspace_ok(param[0]))
+        return MON_BINARY_ERR_MEMSPACE;
+
+    addr = mon_binary_get_word(param + 1);
+    end = mon_binary_get_word(param + 3);
+
+    if (end < addr)
+        return MON_BINARY_ERR_PARAMETER;
+
+    for (; addr <= end; addr++)
+        mon_binary_put_byte(out, mon_get_mem_val(param[0], (WORD)addr));
+
+    return MON_BINARY_ERR_OK;
+}
+
+static int mon_binary_mem_set(const BYTE *param, DWORD len)
+{
+    unsigned int addr;
+    DWORD i;
+
+    if (len < 3)
+        return MON_BINARY_ERR_LENGTH;
+    if (!mon_binary_memspace_ok(param[0]))
+        return MON_BINARY_ERR_MEMSPACE;
+
+    addr = mon_binary_get_word(param + 1);
+
+    if (addr + (len - 3) > 0x10000)
+        return MON_BINARY_ERR_PARAMETER;
+
+    for (i = 3; i < len; i++)
+        mon_set_mem_val(param[0], (WORD)(addr++), param[i]);
+
+    return MON_BINARY_ERR_OK;
+}
+
+static int mon_binary_regs_get(const BYTE *param, DWORD len,
+                               mon_binary_buffer_t *out)
+{
+    mon_reg_list_t *list, *reg;
+    size_t name_len;
+
+    if (len != 1)
+        return MON_BINARY_ERR_LENGTH;
+    if (!mon_binary_memspace_ok(param[0]))
+        return MON_BINARY_ERR_MEMSPACE;
+
+    list = mon_register_list_get(param[0]);
+
+    for (reg = list; reg != NULL; reg = reg->next) {
+        name_len = strlen(reg->name);
+        mon_binary_put_byte(out, (BYTE)name_len);
+        mon_binary_put(out, (const BYTE *)reg->name, name_len);
+        mon_binary_put_byte(out, (BYTE)reg->size);
+        mon_binary_put_dword(out, reg->val);
+    }
+
+    lib_free(list);
+
+    return MON_BINARY_ERR_OK;
+}
+
+static int mon_binary_reg_set(const BYTE *param, DWORD len)
+{
+    mon_reg_list_t reg;
+    char *name;
+
+    if (len < 2 || len != 2 + (DWORD)param[1] + 4)
+        return MON_BINARY_ERR_LENGTH;
+    if (!mon_binary_memspace_ok(param[0]))
+        return MON_BINARY_ERR_MEMSPACE;
+
+    name = lib_malloc(param[1] + 1);
+    memcpy(name, param + 2, param[1]);
+    name[param[1]] = 0;
+
+    reg.name = name;
+    reg.val = mon_binary_get_dword(param + 2 + param[1]);
+    reg.size = 0;
+    reg.flags = 0;
+    reg.next = NULL;
+
+    monitor_cpu_for_memspace[param[0]]->mon_register_list_set(&reg,
+                                                              param[0]);
+
+    lib_free(name);
+
+    return MON_BINARY_ERR_OK;
+}
+
+static int mon_binary_checkpoint_set(const BYTE *param, DWORD len,
+                                     mon_binary_buffer_t *out)
+{
+    MEMSPACE mem;
+    int brknum;
+
+    if (len != 6)
+        return MON_BINARY_ERR_LENGTH;
+    if (!mon_binary_memspace_ok(param[0]))
+        return MON_BINARY_ERR_MEMSPACE;
+
+    mem = (MEMSPACE)param[0];
+
+    brknum = mon_breakpoint_add_checkpoint(
+                 new_addr(mem, mon_binary_get_word(param + 1)),
+                 new_addr(mem, mon_binary_get_word(param + 3)),
+                 (param[5] & MON_BINARY_CP_TRACE) ? TRUE : FALSE,
+                 (param[5] & MON_BINARY_CP_LOAD) ? TRUE : FALSE,
+                 (param[5] & MON_BINARY_CP_STORE) ? TRUE : FALSE,
+                 (param[5] & MON_BINARY_CP_TEMPORARY) ? TRUE : FALSE);
+
+    mon_binary_put_dword(out, (DWORD)brknum);
+
+    return MON_BINARY_ERR_OK;
+}
+
+static int mon_binary_snapshot_save(mon_binary_buffer_t *out)
+{
+    char *name;
+    FILE *fd;
+    BYTE data[0x1000];
+    size_t len;
+    int err = MON_BINARY_ERR_FAILED;
+
+    name = archdep_tmpnam();
+
+    if (machine_write_snapshot(name, 0, 0, 0) >= 0) {
+        fd = fopen(name, MODE_READ);
+        if (fd != NULL) {
+            while ((len = fread(data, 1, sizeof(data), fd)) > 0)
+                mon_binary_put(out, data, len);
+            fclose(fd);
+            err = MON_BINARY_ERR_OK;
+        }
+    }
+
+    ioutil_remove(name);
+    lib_free(name);
+
+    return err;
+}
+
+static int mon_binary_snapshot_load(const BYTE *param, DWORD len)
+{
+    char *name;
+    FILE *fd;
+    int err = MON_BINARY_ERR_FAILED;
+
+    name = archdep_tmpnam();
+
+    fd = fopen(name, MODE_WRITE);
+    if (fd != NULL) {
+        if (fwrite(param, 1, len, fd) == len) {
+            fclose(fd);
+            if (machine_read_snapshot(name, 0) >= 0)
+                err = MON_BINARY_ERR_OK;
+        } else {
+            fclose(fd);
+        }
+    }
+
+    ioutil_remove(name);
+    lib_free(name);
+
+    return err;
+}
+
+/* Execute the binary request `body' and send the response.  Returns the
+   command line to leave the monitor with, if the request asked for it.  */
+static char *mon_binary_process(const BYTE *body, DWORD body_len)
+{
+    mon_binary_buffer_t out;
+    const BYTE *param;
+    DWORD len;
+    size_t entry;
+    BYTE cmd;
+    int err;
+    char *exit_cmd = NULL;
+
+    out.data = NULL;
+    out.len = 0;
+    out.size = 0;
+
+    mon_binary_put_byte(&out, MON_BINARY_STX);
+    mon_binary_put_dword(&out, 0);
+
+    while (body_len > 0) {
+        cmd = body[0];
+
+        entry = out.len;
+        mon_binary_put_byte(&out, cmd);
+        mon_binary_put_byte(&out, MON_BINARY_ERR_OK);
+        mon_binary_put_dword(&out, 0);
+
+        if (body_len < 5 || mon_binary_get_dword(body + 1) > body_len - 5) {
+            out.data[entry + 1] = MON_BINARY_ERR_LENGTH;
+            break;
+        }
+
+        len = mon_binary_get_dword(body + 1);
+        param = body + 5;
+        body += 5 + len;
+        body_len -= 5 + len;
+
+        switch (cmd) {
+          case MON_BINARY_MEM_GET:
+            err = mon_binary_mem_get(param, len, &out);
+            break;
+          case MON_BINARY_MEM_SET:
+            err = mon_binary_mem_set(param, len);
+            break;
+          case MON_BINARY_REGS_GET:
+            err = mon_binary_regs_get(param, len, &out);
+            break;
+          case MON_BINARY_REG_SET:
+            err = mon_binary_reg_set(param, len);
+            break;
+          case MON_BINARY_CHECKPOINT_SET:
+            err = mon_binary_checkpoint_set(param, len, &out);
+            break;
+          case MON_BINARY_CHECKPOINT_DELETE:
+            if (len != 4) {
+                err = MON_BINARY_ERR_LENGTH;
+            } else {
+                mon_breakpoint_delete_checkpoint(
+                    (int)mon_binary_get_dword(param));
+                err = MON_BINARY_ERR_OK;
+            }
+            break;
+          case MON_BINARY_STEP:
+            if (len != 3) {
+                err = MON_BINARY_ERR_LENGTH;
+            } else {
+                lib_free(exit_cmd);
+                exit_cmd = lib_msprintf("%s $%x", param[2] ? "n" : "z",
+                                        mon_binary_get_word(param));
+                err = MON_BINARY_ERR_OK;
+            }
+            break;
+          case MON_BINARY_CONTINUE:
+            lib_free(exit_cmd);
+            exit_cmd = lib_stralloc("x");
+            err = MON_BINARY_ERR_OK;
+            break;
+          case MON_BINARY_SNAPSHOT_SAVE:
+            err = mon_binary_snapshot_save(&out);
+            break;
+          case MON_BINARY_SNAPSHOT_LOAD:
+            err = mon_binary_snapshot_load(param, len);
+            break;
+          default:
+            err = MON_BINARY_ERR_COMMAND;
+            break;
+        }
+
+        out.data[entry + 1] = (BYTE)err;
+        if (err != MON_BINARY_ERR_OK)
+            out.len = entry + 6;
+        mon_binary_set_dword(out.data + entry + 2,
+                             (DWORD)(out.len - entry - 6));
+    }
+
+    mon_binary_set_dword(out.data + 1, (DWORD)(out.len - 5));
+    monitor_network_transmit((const char *)out.data, out.len);
+    lib_free(out.data);
+
+    return exit_cmd;
+}
+
 char * monitor_network_get_command_line(void)
 {
-    static char buffer[200] = { 0 };
-    static int bufferpos = 0;
+    static char * buffer = NULL;
+    static size_t buffer_size = 0;
+    static size_t bufferpos = 0;
 
     char * p = NULL;
     char * cr;
 
+    if (buffer == NULL) {
+        buffer_size = MONITOR_NETWORK_LINE_MAX;
+        buffer = lib_calloc(1, buffer_size);
+    }
+
     do {
         if (monitor_network_data_available()) {
 
-            int n = monitor_network_receive(buffer + bufferpos, sizeof buffer - bufferpos - 1);
+            int n = monitor_network_receive(buffer + bufferpos, buffer_size - bufferpos - 1);
 
             if (n > 0) {
                 bufferpos += n;
+                buffer[bufferpos] = 0;
             }
             else if (n <= 0) {
                 monitor_network_quit();
@@ -144,19 +561,55 @@ char * monitor_network_get_command_line(void)
             }
         }
 
+        if (bufferpos > 0 && buffer[0] == MON_BINARY_STX) {
+            size_t total;
+
+            if (bufferpos >= 5) {
+                total = 5 + mon_binary_get_dword((BYTE *)buffer + 1);
+
+                if (total > MONITOR_NETWORK_REQUEST_MAX) {
+                    log_message(LOG_DEFAULT, "monitor_network_get_command_line(): request too large, breaking connection");
+                    bufferpos = 0;
+                    buffer[0] = 0;
+                    monitor_network_quit();
+                    break;
+                }
+
+                if (bufferpos >= total) {
+                    p = mon_binary_process((BYTE *)buffer + 5,
+                                           (DWORD)(total - 5));
+
+                    memmove(buffer, buffer + total, bufferpos - total);
+                    bufferpos -= total;
+                    buffer[bufferpos] = 0;
+
+                    if (p != NULL)
+                        break;
+                    continue;
+                }
+
+                if (total + 1 > buffer_size) {
+                    buffer_size = total + 1;
+                    buffer = lib_realloc(buffer, buffer_size);
+                }
+            }
+
+            ui_dispatch_next_event();
+            continue;
+        }
+
         cr = strchr(buffer, '\n');
 
         if (cr) {
             *cr = 0;
             p = lib_stralloc(buffer);
 
-            memmove(buffer, cr + 1, strlen(cr+1) );
-
             bufferpos -= (int)strlen(p) + 1;
+            memmove(buffer, cr + 1, bufferpos);
             buffer[bufferpos] = 0;
             break;
         }
-        else if (bufferpos >= sizeof buffer) {
+        else if (bufferpos >= MONITOR_NETWORK_LINE_MAX - 1) {
             /* we have a command that is too large: 
              * process it anyway, so the sender knows something is wrong
              */
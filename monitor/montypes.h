@@ -180,6 +180,14 @@ typedef struct cpuhistory_s cpuhistory_t;
 #define any_watchpoints_load(mem) (watchpoints_load[(mem)] != NULL)
 #define any_watchpoints_store(mem) (watchpoints_store[(mem)] != NULL)
 
+/* Checkpoint bitmaps, one bit per address; see mon_breakpoint.c.  */
+#define checkpoint_bitmap_test(bitmap, addr) \
+    ((bitmap)[((addr) & 0xffff) >> 3] & (1 << ((addr) & 7)))
+
+extern BYTE *breakpoints_bitmap[NUM_MEMSPACES];
+extern BYTE *watchpoints_load_bitmap[NUM_MEMSPACES];
+extern BYTE *watchpoints_store_bitmap[NUM_MEMSPACES];
+
 #define new_cond ((cond_node_t *)(lib_malloc(sizeof(cond_node_t))))
 #ifndef HAVE_MEMSPACE24
 #define addr_memspace(ma) (HI16_TO_LO16(ma))
@@ -249,6 +257,7 @@ extern void mon_cpuhistory(int count);
 extern void mon_memmap_zap(void);
 extern void mon_memmap_show(int mask, MON_ADDR start_addr, MON_ADDR end_addr);
 extern void mon_memmap_save(const char* filename, int format);
+extern int mon_memmap_history_save(const char *filename);
 extern void mon_reset_machine(int type);
 extern void mon_resource_get(const char *name);
 extern void mon_resource_set(const char *name, const char* value);
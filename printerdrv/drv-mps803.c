@@ -75,6 +75,10 @@ static BYTE charset[512][7];
 static mps_t drv_mps803[3];
 static palette_t *palette = NULL;
 
+/* If nonzero, loading the charset and the palette has been attempted,
+   negative if it failed.  */
+static int data_loaded = 0;
+
 /* Logging goes here.  */
 static log_t drv803_log = LOG_ERR;
 
@@ -336,6 +340,39 @@ static int init_charset(BYTE charset[512][7], const char *name)
     return 0;
 }
 
+/* The charset and the palette are only needed once something is printed,
+   so they are loaded by the first open instead of at startup.  */
+static int drv_mps803_load_data(void)
+{
+    static const char *color_names[2] =
+    {
+      "Black", "White"
+    };
+
+    if (data_loaded)
+        return (data_loaded < 0) ? -1 : 0;
+
+    data_loaded = -1;
+
+    if (init_charset(charset, "mps803") < 0)
+        return -1;
+
+    palette = palette_create(2, color_names);
+
+    if (palette == NULL)
+        return -1;
+
+    if (palette_load("mps803" FSDEV_EXT_SEP_STR "vpl", palette) < 0) {
+        log_error(drv803_log, "Cannot load palette file `%s'.",
+                  "mps803" FSDEV_EXT_SEP_STR "vpl");
+        return -1;
+    }
+
+    data_loaded = 1;
+
+    return 0;
+}
+
 /* ------------------------------------------------------------------------- */
 /* Interface to the upper layer.  */
 
@@ -343,6 +380,9 @@ static int drv_mps803_open(unsigned int prnr, unsigned int secondary)
 {
     output_parameter_t output_parameter;
 
+    if (drv_mps803_load_data() < 0)
+        return -1;
+
     output_parameter.maxcol = MAX_COL;
     output_parameter.maxrow = MAX_ROW;
     output_parameter.dpi_x = 72;
@@ -400,26 +440,8 @@ int drv_mps803_init_resources(void)
 
 int drv_mps803_init(void)
 {
-    static const char *color_names[2] =
-    {
-      "Black", "White"
-    };
-
     drv803_log = log_open("MPS-803");
 
-    init_charset(charset, "mps803");
-
-    palette = palette_create(2, color_names);
-
-    if (palette == NULL)
-        return -1;
-
-    if (palette_load("mps803" FSDEV_EXT_SEP_STR "vpl", palette) < 0) {
-        log_error(drv803_log, "Cannot load palette file `%s'.",
-                  "mps803" FSDEV_EXT_SEP_STR "vpl");
-        return -1;
-    }
-
     return 0;
 }
 
@@ -102,6 +102,10 @@ typedef struct nl10_s
 
 static palette_t *palette = NULL;
 
+/* If nonzero, loading the ROM charsets and the palette has been attempted,
+   negative if it failed.  */
+static int data_loaded = 0;
+
 /* Logging goes here.  */
 static log_t drvnl10_log = LOG_ERR;
 
@@ -1862,11 +1866,47 @@ static int handle_esc_control_sequence(nl10_t *nl10, unsigned int prnr, const BY
 /* ------------------------------------------------------------------------- */
 /* Interface to the upper layer.  */
 
+/* The ROM charsets and the palette are only needed once something is
+   printed, so they are loaded by the first open instead of at startup.  */
+static int drv_nl10_load_data(void)
+{
+  static const char *color_names[2] =
+  {
+    "Black", "White"
+  };
+
+  if ( data_loaded )
+    return ( data_loaded < 0 ) ? -1 : 0;
+
+  data_loaded = -1;
+
+  if ( drv_nl10_init_charset() < 0 )
+    return -1;
+
+  palette = palette_create(2, color_names);
+
+  if (palette == NULL)
+    return -1;
+
+  if (palette_load("mps803" FSDEV_EXT_SEP_STR "vpl", palette) < 0) {
+    log_error(drvnl10_log, "Cannot load palette file `%s'.",
+              "mps803" FSDEV_EXT_SEP_STR "vpl");
+    return -1;
+  }
+
+  data_loaded = 1;
+
+  return 0;
+}
+
 static int drv_nl10_open(unsigned int prnr, unsigned int secondary)
 {
   int ret;
   nl10_t *nl10 = &(drv_nl10[prnr]);
 
+  if ( drv_nl10_load_data() < 0 )
+    return -1;
+
   if ( !nl10->isopen )
     {
       output_parameter_t output_parameter;
@@ -1946,10 +1986,6 @@ int drv_nl10_init_resources(void)
 int drv_nl10_init(void)
 {
     int i;
-    static const char *color_names[2] =
-    {
-      "Black", "White"
-    };
 
     drvnl10_log = log_open("NL10");
 
@@ -1961,20 +1997,6 @@ int drv_nl10_init(void)
 	drv_nl10[i].isopen = 0;
       }
 
-    if ( drv_nl10_init_charset() < 0 )
-      return -1;
-
-    palette = palette_create(2, color_names);
-
-    if (palette == NULL)
-        return -1;
-
-    if (palette_load("mps803" FSDEV_EXT_SEP_STR "vpl", palette) < 0) {
-      log_error(drvnl10_log, "Cannot load palette file `%s'.",
-                "mps803" FSDEV_EXT_SEP_STR "vpl");
-      return -1;
-    }
-
     log_message(drvnl10_log, "Printer driver initialized.");
 
     return 0;
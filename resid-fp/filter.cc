@@ -71,6 +71,7 @@ void FilterFP::enable_filter(bool enable)
   enabled = enable;
   if (! enabled)
     filt = 0; // XXX should also restore this...
+  set_routing();
 }
 
 // ----------------------------------------------------------------------------
@@ -117,6 +118,7 @@ void FilterFP::set_type3_properties(float br, float o, float s, float mfr)
     type3_offset = o;
     type3_steepness = -logf(s) / 512.f; /* s^x to e^(x*ln(s)), 1/e^x == e^-x. */
     type3_minimumfetresistance = mfr;
+    set_type3_exp_table();
     set_w0();
 }
 
@@ -133,6 +135,7 @@ void FilterFP::reset()
   type4_w0_cache = 0;
   set_w0();
   set_Q();
+  set_routing();
 }
 
 // ----------------------------------------------------------------------------
@@ -155,6 +158,7 @@ void FilterFP::writeRES_FILT(reg8 res_filt)
   res = (res_filt >> 4) & 0x0f;
   set_Q();
   filt = enabled ? res_filt & 0x0f : 0;
+  set_routing();
 }
 
 void FilterFP::writeMODE_VOL(reg8 mode_vol)
@@ -165,6 +169,38 @@ void FilterFP::writeMODE_VOL(reg8 mode_vol)
 
   vol = mode_vol & 0x0f;
   volf = static_cast<float>(vol) / 15.f;
+  set_routing();
+}
+
+// Update the mixing gains used by clock().
+void FilterFP::set_routing()
+{
+  for (int i = 0; i < 4; i++) {
+    route_in[i] = (filt & (1 << i)) ? 1.f : 0.f;
+    route_out[i] = 1.f - route_in[i];
+  }
+  // NB! Voice 3 is not silenced by voice3off if it is routed through
+  // the filter.
+  if (voice3off) {
+    route_out[2] = 0.f;
+  }
+  for (int i = 0; i < 3; i++) {
+    mode_gain[i] = (hp_bp_lp & (1 << i)) ? 1.f : 0.f;
+  }
+}
+
+// Sample the 6581 FET resistance shape. The table spans the input levels
+// where the resistance still matters; it has decayed to e^-12 at the end of
+// the range. It only depends on the steepness, not on the cutoff.
+void FilterFP::set_type3_exp_table()
+{
+  type3_exp_range = 12.f / -type3_steepness;
+  type3_exp_scale = TYPE3_EXP_TABLE_SIZE / type3_exp_range;
+
+  for (int i = 0; i <= TYPE3_EXP_TABLE_SIZE; i++) {
+    const float dist = static_cast<float>(i) / type3_exp_scale;
+    type3_exp_table[i] = expf(dist * type3_steepness);
+  }
 }
 
 // Set filter cutoff frequency.
@@ -173,6 +209,7 @@ void FilterFP::set_w0()
   if (model == MOS6581FP) {
     float type3_fc_kink = SIDFP::kinked_dac(fc, nonlinearity, 11);
     type3_fc_kink_exp = type3_offset * expf(type3_fc_kink * type3_steepness * 512.f);
+    type3_w0_zero = type3_w0_exact(0.f);
   }
   if (model == MOS8580FP) {
     type4_w0_cache = type4_w0();
@@ -23,6 +23,9 @@
 #include <math.h>
 #include "siddefs-fp.h"
 
+// Number of segments in the 6581 FET resistance table.
+#define TYPE3_EXP_TABLE_SIZE 1024
+
 // ----------------------------------------------------------------------------
 // The SID filter is modeled with a two-integrator-loop biquadratic filter,
 // which has been confirmed by Bob Yannes to be the actual circuit used in
@@ -146,7 +149,10 @@ private:
   void set_Q();
   void set_w0();
   float type3_w0(const float dist);
+  float type3_w0_exact(const float dist);
+  void set_type3_exp_table();
   float type4_w0();
+  void set_routing();
   void calculate_helpers();
   void nuke_denormals();
   float waveshaper1(float value);
@@ -195,6 +201,18 @@ private:
   /* Resonance/Distortion/Type3/Type4 helpers. */
   float type4_w0_cache, _1_div_Q, type3_fc_kink_exp, distortion_CT;
 
+  /* Voice routing into (in) and around (out) the filter and mixing of the
+   * filter outputs, as 0/1 gains updated on register writes so that the
+   * per-cycle mixing is free of branches. */
+  float route_in[4], route_out[4], mode_gain[3];
+
+  /* 6581 FET resistance shape e^(dist * type3_steepness), sampled over
+   * [0, type3_exp_range[ when the type 3 properties change. The cutoff
+   * only scales it by type3_fc_kink_exp, so FC writes leave it alone.
+   * At and below 0 the integrator cutoff does not depend on the level. */
+  float type3_exp_table[TYPE3_EXP_TABLE_SIZE + 1];
+  float type3_exp_range, type3_exp_scale, type3_w0_zero;
+
   float nonlinearity;
 friend class SIDFP;
 };
@@ -236,7 +254,7 @@ static float fastexp(float val) {
 }
 
 RESID_INLINE
-float FilterFP::type3_w0(const float dist)
+float FilterFP::type3_w0_exact(const float dist)
 {
     float fetresistance = type3_fc_kink_exp;
     if (dist > 0) {
@@ -250,6 +268,27 @@ float FilterFP::type3_w0(const float dist)
     return distortion_CT * _1_div_resistance;
 }
 
+RESID_INLINE
+float FilterFP::type3_w0(const float dist)
+{
+    if (dist <= 0.f) {
+        return type3_w0_zero;
+    }
+
+    /* linear interpolation between the table points */
+    const float x = dist * type3_exp_scale;
+    if (! (x < static_cast<float>(TYPE3_EXP_TABLE_SIZE))) {
+        return type3_w0_exact(dist);
+    }
+    const int i = static_cast<int>(x);
+    const float frac = x - static_cast<float>(i);
+    const float fetresistance = type3_fc_kink_exp
+        * (type3_exp_table[i] + frac * (type3_exp_table[i + 1] - type3_exp_table[i]));
+    const float dynamic_resistance = type3_minimumfetresistance + fetresistance;
+
+    return distortion_CT * (type3_baseresistance + dynamic_resistance) / (type3_baseresistance * dynamic_resistance);
+}
+
 RESID_INLINE
 float FilterFP::type4_w0()
 {
@@ -275,45 +314,23 @@ float FilterFP::clock(float voice1,
 		   float voice3,
 		   float ext_in)
 {
-    float Vi = 0.f, Vf = 0.f;
-
     // Route voices into or around filter.
-    ((filt & 1) ? Vi : Vf) += voice1;
-    ((filt & 2) ? Vi : Vf) += voice2;
-    // NB! Voice 3 is not silenced by voice3off if it is routed through
-    // the filter.
-    if (filt & 4) {
-	Vi += voice3;
-    } else if (! voice3off) {
-	Vf += voice3;
-    }
-    ((filt & 8) ? Vi : Vf) += ext_in;
+    float Vi = voice1 * route_in[0] + voice2 * route_in[1]
+             + voice3 * route_in[2] + ext_in * route_in[3];
+    float Vf = voice1 * route_out[0] + voice2 * route_out[1]
+             + voice3 * route_out[2] + ext_in * route_out[3]
+             + Vlp * mode_gain[0] + Vbp * mode_gain[1] + Vhp * mode_gain[2];
 
-    if (hp_bp_lp & 1) {
-	Vf += Vlp;
-    }
-    if (hp_bp_lp & 2) {
-	Vf += Vbp;
-    }
-    if (hp_bp_lp & 4) {
-	Vf += Vhp;
-    }
-    
     if (model == MOS6581FP) {
         Vlp -= Vbp * type3_w0(Vbp);
         Vbp -= Vhp * type3_w0(Vhp);
         Vhp = (Vbp * _1_div_Q - Vlp - Vi) * attenuation;
 
         /* output strip mixing to filter state */
-        if (hp_bp_lp & 1) {
-            Vlp += Vf * intermixing_leaks;
-        }
-        if (hp_bp_lp & 2) {
-            Vbp += Vf * intermixing_leaks;
-        }
-        if (hp_bp_lp & 4) {
-            Vhp += Vf * intermixing_leaks;
-        }
+        const float leak = Vf * intermixing_leaks;
+        Vlp += leak * mode_gain[0];
+        Vbp += leak * mode_gain[1];
+        Vhp += leak * mode_gain[2];
 
         Vf *= volf;
         Vf = waveshaper1(Vf);
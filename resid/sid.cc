@@ -638,29 +638,13 @@ void SID::clock()
 
 
 // ----------------------------------------------------------------------------
-// SID clocking - delta_t cycles.
+// Clock and synchronize oscillators - delta_t cycles.
 // ----------------------------------------------------------------------------
-void SID::clock(cycle_count delta_t)
+RESID_INLINE
+void SID::clock_oscillators(cycle_count delta_t)
 {
   int i;
 
-  if (delta_t <= 0) {
-    return;
-  }
-
-  // Age bus value.
-  bus_value_ttl -= delta_t;
-  if (bus_value_ttl <= 0) {
-    bus_value = 0;
-    bus_value_ttl = 0;
-  }
-
-  // Clock amplitude modulators.
-  for (i = 0; i < 3; i++) {
-    voice[i].envelope.clock(delta_t);
-  }
-
-  // Clock and synchronize oscillators.
   // Loop until we reach the current cycle.
   cycle_count delta_t_osc = delta_t;
   while (delta_t_osc) {
@@ -707,6 +691,34 @@ void SID::clock(cycle_count delta_t)
 
     delta_t_osc -= delta_t_min;
   }
+}
+
+
+// ----------------------------------------------------------------------------
+// SID clocking - delta_t cycles.
+// ----------------------------------------------------------------------------
+void SID::clock(cycle_count delta_t)
+{
+  int i;
+
+  if (delta_t <= 0) {
+    return;
+  }
+
+  // Age bus value.
+  bus_value_ttl -= delta_t;
+  if (bus_value_ttl <= 0) {
+    bus_value = 0;
+    bus_value_ttl = 0;
+  }
+
+  // Clock amplitude modulators.
+  for (i = 0; i < 3; i++) {
+    voice[i].envelope.clock(delta_t);
+  }
+
+  // Clock and synchronize oscillators.
+  clock_oscillators(delta_t);
 
   // Clock filter.
   filter.clock(delta_t,
@@ -717,6 +729,62 @@ void SID::clock(cycle_count delta_t)
 }
 
 
+// ----------------------------------------------------------------------------
+// SID clocking - up to delta_t cycles during silence.
+//
+// When all envelopes are frozen at zero, the voice outputs are constant
+// until the next register write. If the filters then do not change state
+// over one cycle, they have settled on a fixed point and the chip output can
+// not change either. The remaining cycles only need to advance the envelope
+// rate counters and the oscillators, which is done analytically.
+//
+// The first cycle is always clocked normally. Returns the number of cycles
+// clocked: 0 if the envelopes are not frozen, 1 if the filters are still
+// moving, and delta_t if the rest of the cycles were skipped.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+cycle_count SID::clock_silent(cycle_count delta_t)
+{
+  int i;
+
+  if (delta_t <= 0
+      || !voice[0].envelope.hold_zero
+      || !voice[1].envelope.hold_zero
+      || !voice[2].envelope.hold_zero) {
+    return 0;
+  }
+
+  sound_sample Vhp = filter.Vhp, Vbp = filter.Vbp, Vlp = filter.Vlp;
+  sound_sample Vnf = filter.Vnf;
+  sound_sample ext_Vlp = extfilt.Vlp, ext_Vhp = extfilt.Vhp, ext_Vo = extfilt.Vo;
+
+  clock();
+
+  if (Vhp != filter.Vhp || Vbp != filter.Vbp || Vlp != filter.Vlp
+      || Vnf != filter.Vnf || ext_Vlp != extfilt.Vlp
+      || ext_Vhp != extfilt.Vhp || ext_Vo != extfilt.Vo) {
+    return 1;
+  }
+
+  if (--delta_t) {
+    // Age bus value.
+    bus_value_ttl -= delta_t;
+    if (bus_value_ttl <= 0) {
+      bus_value = 0;
+      bus_value_ttl = 0;
+    }
+
+    for (i = 0; i < 3; i++) {
+      voice[i].envelope.clock(delta_t);
+    }
+
+    clock_oscillators(delta_t);
+  }
+
+  return delta_t + 1;
+}
+
+
 // ----------------------------------------------------------------------------
 // SID clocking with audio sampling.
 // Fixpoint arithmetics is used.
@@ -802,7 +870,7 @@ int SID::clock_interpolate(cycle_count& delta_t, short* buf, int n,
     if (s >= n) {
       return s;
     }
-    for (i = 0; i < delta_t_sample - 1; i++) {
+    for (i = clock_silent(delta_t_sample - 1); i < delta_t_sample - 1; i++) {
       clock();
     }
     if (i < delta_t_sample) {
@@ -819,7 +887,7 @@ int SID::clock_interpolate(cycle_count& delta_t, short* buf, int n,
     sample_prev = sample_now;
   }
 
-  for (i = 0; i < delta_t - 1; i++) {
+  for (i = clock_silent(delta_t - 1); i < delta_t - 1; i++) {
     clock();
   }
   if (i < delta_t) {
@@ -910,7 +978,14 @@ int SID::clock_resample_interpolate(cycle_count& delta_t, short* buf, int n,
     if (s >= n) {
       return s;
     }
-    for (int i = 0; i < delta_t_sample; i++) {
+    // During silence the output is constant for the skipped cycles.
+    int i = 0;
+    for (cycle_count silent = clock_silent(delta_t_sample); i < silent; i++) {
+      sample[sample_index] = sample[sample_index + RINGSIZE] = output();
+      ++sample_index;
+      sample_index &= RINGSIZE - 1;
+    }
+    for (; i < delta_t_sample; i++) {
       clock();
       sample[sample_index] = sample[sample_index + RINGSIZE] = output();
       ++sample_index;
@@ -957,7 +1032,13 @@ int SID::clock_resample_interpolate(cycle_count& delta_t, short* buf, int n,
     buf[s++*interleave] = v;
   }
 
-  for (int i = 0; i < delta_t; i++) {
+  int i = 0;
+  for (cycle_count silent = clock_silent(delta_t); i < silent; i++) {
+    sample[sample_index] = sample[sample_index + RINGSIZE] = output();
+    ++sample_index;
+    sample_index &= RINGSIZE - 1;
+  }
+  for (; i < delta_t; i++) {
     clock();
     sample[sample_index] = sample[sample_index + RINGSIZE] = output();
     ++sample_index;
@@ -987,7 +1068,14 @@ int SID::clock_resample_fast(cycle_count& delta_t, short* buf, int n,
     if (s >= n) {
       return s;
     }
-    for (int i = 0; i < delta_t_sample; i++) {
+    // During silence the output is constant for the skipped cycles.
+    int i = 0;
+    for (cycle_count silent = clock_silent(delta_t_sample); i < silent; i++) {
+      sample[sample_index] = sample[sample_index + RINGSIZE] = output();
+      ++sample_index;
+      sample_index &= RINGSIZE - 1;
+    }
+    for (; i < delta_t_sample; i++) {
       clock();
       sample[sample_index] = sample[sample_index + RINGSIZE] = output();
       ++sample_index;
@@ -1016,7 +1104,13 @@ int SID::clock_resample_fast(cycle_count& delta_t, short* buf, int n,
     buf[s++*interleave] = v;
   }
 
-  for (int i = 0; i < delta_t; i++) {
+  int i = 0;
+  for (cycle_count silent = clock_silent(delta_t); i < silent; i++) {
+    sample[sample_index] = sample[sample_index + RINGSIZE] = output();
+    ++sample_index;
+    sample_index &= RINGSIZE - 1;
+  }
+  for (; i < delta_t; i++) {
     clock();
     sample[sample_index] = sample[sample_index + RINGSIZE] = output();
     ++sample_index;
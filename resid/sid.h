@@ -87,6 +87,8 @@ public:
 
 protected:
   static double I0(double x);
+  RESID_INLINE void clock_oscillators(cycle_count delta_t);
+  RESID_INLINE cycle_count clock_silent(cycle_count delta_t);
   RESID_INLINE int clock_fast(cycle_count& delta_t, short* buf, int n,
 			      int interleave);
   RESID_INLINE int clock_interpolate(cycle_count& delta_t, short* buf, int n,
@@ -91,6 +91,9 @@ typedef struct resource_ram_s {
     /* callback function vector chain */
     struct resource_callback_desc_s *callback;
 
+    /* full hash of the name, compared before the name itself */
+    unsigned int hash_key;
+
     /* number of next entry in hash collision list */
     int hash_next;
 } resource_ram_t;
@@ -110,33 +113,36 @@ static char *machine_id = NULL;
 static void write_resource_item(FILE *f, int num);
 static char *string_resource_item(int num, const char *delim);
 
-/* use a hash table with 1024 entries */
-static const unsigned int logHashSize = 10;
+/* use a hash table with 2048 entries */
+static const unsigned int logHashSize = 11;
 
 static int *hashTable = NULL;
 
 static resource_callback_desc_t *resource_modified_callback = NULL;
 
-/* calculate the hash key */
+/* calculate the hash key (32 bit FNV-1a); the low `logHashSize' bits
+   select the hash table entry */
 static unsigned int resources_calc_hash_key(const char *name)
 {
-    unsigned int key, i, shift;
+    unsigned int key, i;
 
-    key = 0; shift = 0;
+    key = 2166136261U;
     for (i = 0; name[i] != '\0'; i++) {
         /* resources are case-insensitive */
-        unsigned int sym = (unsigned int)tolower(name[i]);
+        key ^= (unsigned int)tolower((unsigned char)name[i]);
+        key *= 16777619U;
+    }
+    return key;
+}
 
-        if (shift >= logHashSize)
-            shift = 0;
+static void resources_add_to_hash_table(resource_ram_t *res)
+{
+    unsigned int slot;
 
-        key ^= (sym << shift);
-        if (shift + 8 > logHashSize) {
-            key ^= (((unsigned int)sym) >> (logHashSize - shift));
-        }
-        shift++;
-    }
-    return (key & ((1 << logHashSize) - 1));
+    res->hash_key = resources_calc_hash_key(res->name);
+    slot = res->hash_key & ((1 << logHashSize) - 1);
+    res->hash_next = hashTable[slot];
+    hashTable[slot] = (int)(res - resources);
 }
 
 
@@ -217,9 +223,6 @@ int resources_register_int(const resource_int_t *r)
     sp = r;
     dp = resources + num_resources;
     while (sp->name != NULL) {
-
-        unsigned int hashkey;
-
         if (sp->value_ptr == NULL || sp->set_func == NULL) {
             archdep_startup_log_error(
                 "Inconsistent resource declaration '%s'.\n", sp->name);
@@ -243,9 +246,7 @@ int resources_register_int(const resource_int_t *r)
         dp->param = sp->param;
         dp->callback = NULL;
 
-        hashkey = resources_calc_hash_key(sp->name);
-        dp->hash_next = hashTable[hashkey];
-        hashTable[hashkey] = (dp - resources);
+        resources_add_to_hash_table(dp);
 
         num_resources++, sp++, dp++;
     }
@@ -261,9 +262,6 @@ int resources_register_string(const resource_string_t *r)
     sp = r;
     dp = resources + num_resources;
     while (sp->name != NULL) {
-
-        unsigned int hashkey;
-
         if (sp->factory_value == NULL
             || sp->value_ptr == NULL || sp->set_func == NULL) {
             archdep_startup_log_error(
@@ -288,9 +286,7 @@ int resources_register_string(const resource_string_t *r)
         dp->param = sp->param;
         dp->callback = NULL;
 
-        hashkey = resources_calc_hash_key(sp->name);
-        dp->hash_next = hashTable[hashkey];
-        hashTable[hashkey] = (dp - resources);
+        resources_add_to_hash_table(dp);
 
         num_resources++, sp++, dp++;
     }
@@ -317,19 +313,35 @@ void resources_shutdown(void)
     lib_free(vice_config_file);
 }
 
-static resource_ram_t *lookup(const char *name)
+static int lookup_index(const char *name)
 {
-    resource_ram_t *res;
     unsigned int hashkey;
+    int i;
 
     hashkey = resources_calc_hash_key(name);
-    res = (hashTable[hashkey] >= 0) ? resources + hashTable[hashkey] : NULL;
-    while (res != NULL) {
-        if (strcasecmp(res->name, name) == 0)
-            return res;
-        res = (res->hash_next >= 0) ? resources + res->hash_next : NULL;
+    i = hashTable[hashkey & ((1 << logHashSize) - 1)];
+    while (i >= 0) {
+        if (resources[i].hash_key == hashkey
+            && strcasecmp(resources[i].name, name) == 0)
+            return i;
+        i = resources[i].hash_next;
     }
-    return NULL;
+    return -1;
+}
+
+static resource_ram_t *lookup(const char *name)
+{
+    int i = lookup_index(name);
+
+    return (i >= 0) ? resources + i : NULL;
+}
+
+static resource_ram_t *lookup_handle(resource_handle_t handle)
+{
+    if (handle < 0 || (unsigned int)handle >= num_resources)
+        return NULL;
+
+    return resources + handle;
 }
 
 resource_type_t resources_query_type(const char *name)
@@ -410,7 +422,7 @@ int resources_init(const char *machine)
     unsigned int i;
 
     machine_id = lib_stralloc(machine);
-    num_allocated_resources = 100;
+    num_allocated_resources = 512;
     num_resources = 0;
     resources = lib_malloc(num_allocated_resources * sizeof(resource_ram_t));
 
@@ -505,6 +517,21 @@ static int resources_set_internal_string(resource_ram_t *r,
     return status;
 }
 
+static int resources_set_int_ram(resource_ram_t *r, int value)
+{
+    if (r->event_relevant == RES_EVENT_STRICT
+        && network_get_mode() != NETWORK_IDLE)
+        return -2;
+
+    if (r->event_relevant == RES_EVENT_SAME && network_connected())
+    {
+        resource_record_event(r, uint_to_void_ptr(value));
+        return 0;
+    }
+
+    return resources_set_internal_int(r, value);
+}
+
 int resources_set_int(const char *name, int value)
 {
     resource_ram_t *r = lookup(name);
@@ -516,17 +543,17 @@ int resources_set_int(const char *name, int value)
         return -1;
     }
 
-    if (r->event_relevant == RES_EVENT_STRICT
-        && network_get_mode() != NETWORK_IDLE)
-        return -2;
+    return resources_set_int_ram(r, value);
+}
 
-    if (r->event_relevant == RES_EVENT_SAME && network_connected())
-    {
-        resource_record_event(r, uint_to_void_ptr(value));
-        return 0;
-    }
+int resources_set_int_by_handle(resource_handle_t handle, int value)
+{
+    resource_ram_t *r = lookup_handle(handle);
 
-    return resources_set_internal_int(r, value);
+    if (r == NULL)
+        return -1;
+
+    return resources_set_int_ram(r, value);
 }
 
 int resources_set_string(const char *name, const char *value)
@@ -655,30 +682,36 @@ int resources_get_value(const char *name, void *value_return)
     return 0;
 }
 
-int resources_get_int(const char *name, int *value_return)
+static int resources_get_int_ram(resource_ram_t *r, int *value_return)
 {
-    resource_ram_t *r = lookup(name);
-
-    if (r == NULL) {
-        log_warning(LOG_DEFAULT,
-                    "Trying to read value from unknown "
-                    "resource `%s'.", name);
+    switch (r->type) {
+      case RES_INTEGER:
+        *value_return = *(int *)r->value_ptr;
+        break;
+      default:
+        log_warning(LOG_DEFAULT, "Unknown resource type for `%s'", r->name);
         return -1;
     }
 
+    return 0;
+}
+
+static int resources_get_string_ram(resource_ram_t *r,
+                                    const char **value_return)
+{
     switch (r->type) {
-      case RES_INTEGER:
-        *value_return = *(int *)r->value_ptr;
+      case RES_STRING:
+        *value_return = *(const char **)r->value_ptr;
         break;
       default:
-        log_warning(LOG_DEFAULT, "Unknown resource type for `%s'", name);
+        log_warning(LOG_DEFAULT, "Unknown resource type for `%s'", r->name);
         return -1;
     }
 
     return 0;
 }
 
-int resources_get_string(const char *name, const char **value_return)
+int resources_get_int(const char *name, int *value_return)
 {
     resource_ram_t *r = lookup(name);
 
@@ -689,16 +722,56 @@ int resources_get_string(const char *name, const char **value_return)
         return -1;
     }
 
-    switch (r->type) {
-      case RES_STRING:
-        *value_return = *(const char **)r->value_ptr;
-        break;
-      default:
-        log_warning(LOG_DEFAULT, "Unknown resource type for `%s'", name);
+    return resources_get_int_ram(r, value_return);
+}
+
+int resources_get_string(const char *name, const char **value_return)
+{
+    resource_ram_t *r = lookup(name);
+
+    if (r == NULL) {
+        log_warning(LOG_DEFAULT,
+                    "Trying to read value from unknown "
+                    "resource `%s'.", name);
         return -1;
     }
 
-    return 0;
+    return resources_get_string_ram(r, value_return);
+}
+
+/* Handles are indices into the resource array, which never shrinks, so they
+   stay valid until `resources_shutdown()'.  */
+resource_handle_t resources_get_handle(const char *name)
+{
+    int i = lookup_index(name);
+
+    if (i < 0) {
+        log_warning(LOG_DEFAULT, "Unknown resource `%s'.", name);
+        return RESOURCE_HANDLE_NONE;
+    }
+
+    return (resource_handle_t)i;
+}
+
+int resources_get_int_by_handle(resource_handle_t handle, int *value_return)
+{
+    resource_ram_t *r = lookup_handle(handle);
+
+    if (r == NULL)
+        return -1;
+
+    return resources_get_int_ram(r, value_return);
+}
+
+int resources_get_string_by_handle(resource_handle_t handle,
+                                   const char **value_return)
+{
+    resource_ram_t *r = lookup_handle(handle);
+
+    if (r == NULL)
+        return -1;
+
+    return resources_get_string_ram(r, value_return);
 }
 
 int resources_get_int_sprintf(const char *name, int *value_return, ...)
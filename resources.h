@@ -102,6 +102,12 @@ struct resource_string_s {
 };
 typedef struct resource_string_s resource_string_t;
 
+/* Stable reference to a registered resource, for code that reads or sets
+   the same resource repeatedly; see `resources_get_handle()'.  */
+typedef int resource_handle_t;
+
+#define RESOURCE_HANDLE_NONE -1
+
 #define RESERR_FILE_NOT_FOUND       -1
 #define RESERR_FILE_INVALID         -2
 #define RESERR_READ_ERROR           -3
@@ -134,6 +140,12 @@ extern int resources_get_string(const char *name, const char **value_return);
 extern int resources_get_int_sprintf(const char *name, int *value_return, ...);
 extern int resources_get_string_sprintf(const char *name,
                                         const char **value_return, ...);
+extern resource_handle_t resources_get_handle(const char *name);
+extern int resources_get_int_by_handle(resource_handle_t handle,
+                                       int *value_return);
+extern int resources_get_string_by_handle(resource_handle_t handle,
+                                          const char **value_return);
+extern int resources_set_int_by_handle(resource_handle_t handle, int value);
 extern int resources_get_default_value(const char *name, void *value_return);
 extern resource_type_t resources_query_type(const char *name);
 extern int resources_save(const char *fname);
@@ -193,6 +193,57 @@ int serial_trap_receive(void)
 }
 
 
+/* Receive the rest of a file being loaded in one go, instead of trapping
+   every byte of the Kernal load loop.  Installed on the `JSR' to the
+   receive routine inside the loop; the load pointer is in 0xae/0xaf.
+   Verify, and timeouts which the Kernal retries, are left to the Kernal
+   code.  */
+int serial_trap_load(void)
+{
+    BYTE data;
+    WORD addr;
+
+    if (serial_truedrive && ((TrapDevice & 0x0f) !=4)
+        && ((TrapDevice & 0x0f) != 5)) {
+        return 0;
+    }
+
+    if (mem_read((WORD)0x93) != 0)
+        return 0;
+
+    addr = (WORD)(mem_read((WORD)0xae) | (mem_read((WORD)0xaf) << 8));
+
+    while (1) {
+        mem_store((WORD)0x90, (BYTE)(serial_get_st() & 0xfd));
+
+        data = serial_iec_bus_read(TrapDevice, TrapSecondary, serial_set_st);
+
+        if (serial_get_st() & 0x02)
+            break;
+
+        mem_store(addr++, data);
+
+        if (serial_get_st() & 0x40)
+            break;
+    }
+
+    mem_store((WORD)0xae, (BYTE)(addr & 0xff));
+    mem_store((WORD)0xaf, (BYTE)(addr >> 8));
+
+    /* Let the Kernal retry after a timeout.  */
+    if (!(serial_get_st() & 0x40))
+        return 0;
+
+    if (eof_callback_func != NULL)
+        eof_callback_func();
+
+    MOS6510_REGS_SET_CARRY(&maincpu_regs, 0);
+    MOS6510_REGS_SET_INTERRUPT(&maincpu_regs, 0);
+
+    return 1;
+}
+
+
 /* Kernal loops serial-port (0xdd00) to see when serial is ready: fake it.
    EEA9 Get serial data and clk in (TKSA subroutine).  */
 
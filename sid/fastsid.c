@@ -637,96 +637,100 @@ inline static void setup_voice(voice_t *pv)
     pv->gateflip = 0;
 }
 
-static SWORD fastsid_calculate_single_sample(sound_t *psid, int i)
-{
-    DWORD o0, o1, o2;
-    int dosync1, dosync2;
-    voice_t *v0, *v1, *v2;
+/* Sample loops specialized for the active voice configuration.  */
+#define fastsid_loop fastsid_loop_plain
+#define FASTSID_LOOP_SYNC 0
+#define FASTSID_LOOP_NOISE 0
+#define FASTSID_LOOP_FILT 0
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_sync
+#define FASTSID_LOOP_SYNC 1
+#define FASTSID_LOOP_NOISE 0
+#define FASTSID_LOOP_FILT 0
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_noise
+#define FASTSID_LOOP_SYNC 0
+#define FASTSID_LOOP_NOISE 1
+#define FASTSID_LOOP_FILT 0
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_sync_noise
+#define FASTSID_LOOP_SYNC 1
+#define FASTSID_LOOP_NOISE 1
+#define FASTSID_LOOP_FILT 0
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_filt
+#define FASTSID_LOOP_SYNC 0
+#define FASTSID_LOOP_NOISE 0
+#define FASTSID_LOOP_FILT 1
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_sync_filt
+#define FASTSID_LOOP_SYNC 1
+#define FASTSID_LOOP_NOISE 0
+#define FASTSID_LOOP_FILT 1
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_noise_filt
+#define FASTSID_LOOP_SYNC 0
+#define FASTSID_LOOP_NOISE 1
+#define FASTSID_LOOP_FILT 1
+#include "fastsidcore.c"
+
+#define fastsid_loop fastsid_loop_sync_noise_filt
+#define FASTSID_LOOP_SYNC 1
+#define FASTSID_LOOP_NOISE 1
+#define FASTSID_LOOP_FILT 1
+#include "fastsidcore.c"
+
+typedef void fastsid_loop_func_t(sound_t *psid, SWORD *pbuf, int nr,
+                                 int interleave, int mix);
+
+/* indexed by 1 * sync + 2 * noise + 4 * filter */
+static fastsid_loop_func_t *const fastsid_loops[8] = {
+    fastsid_loop_plain, fastsid_loop_sync,
+    fastsid_loop_noise, fastsid_loop_sync_noise,
+    fastsid_loop_filt, fastsid_loop_sync_filt,
+    fastsid_loop_noise_filt, fastsid_loop_sync_noise_filt
+};
 
-    setup_sid(psid);
-    v0 = &psid->v[0];
-    setup_voice(v0);
-    v1 = &psid->v[1];
-    setup_voice(v1);
-    v2 = &psid->v[2];
-    setup_voice(v2);
-
-    /* addfptrs, noise & hard sync test */
-    dosync1 = 0;
-    if ((v0->f += v0->fs) < v0->fs) {
-        v0->rv = NSHIFT(v0->rv, 16);
-        if (v1->sync)
-            dosync1 = 1;
-    }
-    dosync2 = 0;
-    if ((v1->f += v1->fs) < v1->fs) {
-        v1->rv = NSHIFT(v1->rv, 16);
-        if (v2->sync)
-            dosync2 = 1;
-    }
-    if ((v2->f += v2->fs) < v2->fs) {
-        v2->rv = NSHIFT(v2->rv, 16);
-        if (v0->sync) {
-        /* hard sync */
-            v0->rv = NSHIFT(v0->rv, v0->f >> 28);
-            v0->f = 0;
-        }
-    }
+#ifdef WAVETABLES
+#define VOICE_HAS_NOISE(pv) ((pv)->noise)
+#else
+#define VOICE_HAS_NOISE(pv) ((pv)->fm == NOISEWAVE)
+#endif
 
-    /* hard sync */
-    if (dosync2) {
-        v2->rv = NSHIFT(v2->rv, v2->f >> 28);
-        v2->f = 0;
-    }
-    if (dosync1) {
-        v1->rv = NSHIFT(v1->rv, v1->f >> 28);
-        v1->f = 0;
-    }
+/* Bring the SID state up to date and pick the sample loop for it.
+   Registers are only stored between two calls, so this is done once per
+   call instead of once per sample.  */
+static fastsid_loop_func_t *fastsid_select_loop(sound_t *psid)
+{
+    voice_t *v = psid->v;
+    int idx = 0;
 
-    /* do adsr */
-    if ((v0->adsr += v0->adsrs) + 0x80000000 < v0->adsrz + 0x80000000)
-        trigger_adsr(v0);
-    if ((v1->adsr += v1->adsrs) + 0x80000000 < v1->adsrz + 0x80000000)
-        trigger_adsr(v1);
-    if ((v2->adsr += v2->adsrs) + 0x80000000 < v2->adsrz + 0x80000000)
-        trigger_adsr(v2);
-
-    /* oscillators */
-    o0 = v0->adsr >> 16;
-    o1 = v1->adsr >> 16;
-    o2 = v2->adsr >> 16;
-    if (o0)
-        o0 *= doosc(v0);
-    if (o1)
-        o1 *= doosc(v1);
-    if (psid->has3 && o2)
-        o2 *= doosc(v2);
-    else
-        o2 = 0;
-    /* sample */
-    if (psid->emulatefilter) {
-        v0->filtIO = ampMod1x8[(o0 >> 22)];
-        dofilter(v0);
-        o0 = ((DWORD)(v0->filtIO) + 0x80) << (7 + 15);
-        v1->filtIO = ampMod1x8[(o1 >> 22)];
-        dofilter(v1);
-        o1 = ((DWORD)(v1->filtIO) + 0x80) << (7 + 15);
-        v2->filtIO = ampMod1x8[(o2 >> 22)];
-        dofilter(v2);
-        o2 = ((DWORD)(v2->filtIO) + 0x80) << (7 + 15);
-    }
+    setup_sid(psid);
+    setup_voice(&v[0]);
+    setup_voice(&v[1]);
+    setup_voice(&v[2]);
+
+    if (v[0].sync || v[1].sync || v[2].sync)
+        idx |= 1;
+    if (VOICE_HAS_NOISE(&v[0]) || VOICE_HAS_NOISE(&v[1])
+        || VOICE_HAS_NOISE(&v[2]))
+        idx |= 2;
+    if (psid->emulatefilter)
+        idx |= 4;
 
-    return ((SDWORD)((o0 + o1 + o2) >> 20) - 0x600) * psid->vol;
+    return fastsid_loops[idx];
 }
 
 static int fastsid_calculate_samples(sound_t *psid, SWORD *pbuf, int nr,
                                      int interleave, int *delta_t)
 {
-    int i;
-
-    for (i = 0; i < nr; i++) {
-        pbuf[i * interleave] = fastsid_calculate_single_sample(psid, i);
-    }
+    fastsid_select_loop(psid)(psid, pbuf, nr, interleave, 0);
 
     return nr;
 }
@@ -734,11 +738,7 @@ static int fastsid_calculate_samples(sound_t *psid, SWORD *pbuf, int nr,
 int fastsid_calculate_samples_mix(sound_t *psid, SWORD *pbuf, int nr,
                                   int interleave, int *delta_t)
 {
-    int i;
-
-    for (i = 0; i< nr; i++) {
-        pbuf[i * interleave] = sound_audio_mix(pbuf[i * interleave], fastsid_calculate_single_sample(psid, i));
-    }
+    fastsid_select_loop(psid)(psid, pbuf, nr, interleave, 1);
 
     return nr;
 }
@@ -0,0 +1,153 @@
+/*
+ * fastsidcore.c - MOS6581 (SID) emulation, specialized sample loop.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* This file is included by fastsid.c once for every sample loop variant.
+   The includer defines:
+
+   fastsid_loop       name of the generated function
+   FASTSID_LOOP_SYNC  non-zero if any voice uses hard sync
+   FASTSID_LOOP_NOISE non-zero if any voice uses the noise waveform
+   FASTSID_LOOP_FILT  non-zero if filter emulation is enabled
+
+   The voice and SID structures must be up to date; registers cannot change
+   while the loop is running.  */
+
+static void fastsid_loop(sound_t *psid, SWORD *pbuf, int nr, int interleave,
+                         int mix)
+{
+    DWORD o0, o1, o2;
+    SWORD sample;
+    voice_t *v0, *v1, *v2;
+    int i;
+#if FASTSID_LOOP_SYNC
+    int dosync1, dosync2;
+#endif
+
+    v0 = &psid->v[0];
+    v1 = &psid->v[1];
+    v2 = &psid->v[2];
+
+    for (i = 0; i < nr; i++) {
+        /* addfptrs, noise & hard sync test */
+#if FASTSID_LOOP_SYNC
+        dosync1 = 0;
+        if ((v0->f += v0->fs) < v0->fs) {
+            v0->rv = NSHIFT(v0->rv, 16);
+            if (v1->sync)
+                dosync1 = 1;
+        }
+        dosync2 = 0;
+        if ((v1->f += v1->fs) < v1->fs) {
+            v1->rv = NSHIFT(v1->rv, 16);
+            if (v2->sync)
+                dosync2 = 1;
+        }
+        if ((v2->f += v2->fs) < v2->fs) {
+            v2->rv = NSHIFT(v2->rv, 16);
+            if (v0->sync) {
+            /* hard sync */
+                v0->rv = NSHIFT(v0->rv, v0->f >> 28);
+                v0->f = 0;
+            }
+        }
+
+        /* hard sync */
+        if (dosync2) {
+            v2->rv = NSHIFT(v2->rv, v2->f >> 28);
+            v2->f = 0;
+        }
+        if (dosync1) {
+            v1->rv = NSHIFT(v1->rv, v1->f >> 28);
+            v1->f = 0;
+        }
+#else
+        if ((v0->f += v0->fs) < v0->fs)
+            v0->rv = NSHIFT(v0->rv, 16);
+        if ((v1->f += v1->fs) < v1->fs)
+            v1->rv = NSHIFT(v1->rv, 16);
+        if ((v2->f += v2->fs) < v2->fs)
+            v2->rv = NSHIFT(v2->rv, 16);
+#endif
+
+        /* do adsr */
+        if ((v0->adsr += v0->adsrs) + 0x80000000 < v0->adsrz + 0x80000000)
+            trigger_adsr(v0);
+        if ((v1->adsr += v1->adsrs) + 0x80000000 < v1->adsrz + 0x80000000)
+            trigger_adsr(v1);
+        if ((v2->adsr += v2->adsrs) + 0x80000000 < v2->adsrz + 0x80000000)
+            trigger_adsr(v2);
+
+        /* oscillators */
+        o0 = v0->adsr >> 16;
+        o1 = v1->adsr >> 16;
+        o2 = v2->adsr >> 16;
+#if defined(WAVETABLES) && !FASTSID_LOOP_NOISE
+        /* plain wavetable lookup, see doosc() */
+        if (o0)
+            o0 *= v0->wt[(v0->f + v0->wtpf) >> v0->wtl]
+                  ^ v0->wtr[v2->f >> 31];
+        if (o1)
+            o1 *= v1->wt[(v1->f + v1->wtpf) >> v1->wtl]
+                  ^ v1->wtr[v0->f >> 31];
+        if (psid->has3 && o2)
+            o2 *= v2->wt[(v2->f + v2->wtpf) >> v2->wtl]
+                  ^ v2->wtr[v1->f >> 31];
+        else
+            o2 = 0;
+#else
+        if (o0)
+            o0 *= doosc(v0);
+        if (o1)
+            o1 *= doosc(v1);
+        if (psid->has3 && o2)
+            o2 *= doosc(v2);
+        else
+            o2 = 0;
+#endif
+        /* sample */
+#if FASTSID_LOOP_FILT
+        v0->filtIO = ampMod1x8[(o0 >> 22)];
+        dofilter(v0);
+        o0 = ((DWORD)(v0->filtIO) + 0x80) << (7 + 15);
+        v1->filtIO = ampMod1x8[(o1 >> 22)];
+        dofilter(v1);
+        o1 = ((DWORD)(v1->filtIO) + 0x80) << (7 + 15);
+        v2->filtIO = ampMod1x8[(o2 >> 22)];
+        dofilter(v2);
+        o2 = ((DWORD)(v2->filtIO) + 0x80) << (7 + 15);
+#endif
+
+        sample = ((SDWORD)((o0 + o1 + o2) >> 20) - 0x600) * psid->vol;
+
+        if (mix)
+            pbuf[i * interleave] = sound_audio_mix(pbuf[i * interleave],
+                                                   sample);
+        else
+            pbuf[i * interleave] = sample;
+    }
+}
+
+#undef fastsid_loop
+#undef FASTSID_LOOP_SYNC
+#undef FASTSID_LOOP_NOISE
+#undef FASTSID_LOOP_FILT
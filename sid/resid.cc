@@ -69,6 +69,22 @@ static sound_t *resid_open(BYTE *sidstate)
     return psid;
 }
 
+/* The settings are read again on every sound (re)initialization.  */
+static resource_handle_t filters_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t model_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sampling_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t passband_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t gain_handle = RESOURCE_HANDLE_NONE;
+
+static int resid_get_int(const char *name, resource_handle_t *handle,
+                         int *value_return)
+{
+    if (*handle == RESOURCE_HANDLE_NONE)
+        *handle = resources_get_handle(name);
+
+    return resources_get_int_by_handle(*handle, value_return);
+}
+
 static int resid_init(sound_t *psid, int speed, int cycles_per_sec)
 {
     sampling_method method;
@@ -77,19 +93,20 @@ static int resid_init(sound_t *psid, int speed, int cycles_per_sec)
     double passband, gain;
     int filters_enabled, model, sampling, passband_percentage, gain_percentage;
 
-    if (resources_get_int("SidFilters", &filters_enabled) < 0)
+    if (resid_get_int("SidFilters", &filters_handle, &filters_enabled) < 0)
         return 0;
 
-    if (resources_get_int("SidModel", &model) < 0)
+    if (resid_get_int("SidModel", &model_handle, &model) < 0)
         return 0;
 
-    if (resources_get_int("SidResidSampling", &sampling) < 0)
+    if (resid_get_int("SidResidSampling", &sampling_handle, &sampling) < 0)
         return 0;
 
-    if (resources_get_int("SidResidPassband", &passband_percentage) < 0)
+    if (resid_get_int("SidResidPassband", &passband_handle,
+                      &passband_percentage) < 0)
         return 0;
 
-    if (resources_get_int("SidResidGain", &gain_percentage) < 0)
+    if (resid_get_int("SidResidGain", &gain_handle, &gain_percentage) < 0)
         return 0;
 
     passband = speed * passband_percentage / 200.0;
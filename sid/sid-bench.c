@@ -0,0 +1,279 @@
+/*
+ * sid-bench.c - SID engine benchmark.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Feeds a register write stream recorded with the `dump' sound device
+   (`-sounddev dump') into every available SID engine and sampling method,
+   and reports the cost of each together with a checksum of the generated
+   samples, so optimizations can be checked for accuracy regressions.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "archdep.h"
+#include "crc32.h"
+#include "fastsid.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "resources.h"
+#include "sid-bench.h"
+#include "sid.h"
+#include "sound.h"
+#include "types.h"
+#include "util.h"
+#include "vsyncapi.h"
+
+#ifdef HAVE_RESID
+#include "resid.h"
+#endif
+
+#define SID_BENCH_SAMPLE_RATE   44100
+#define SID_BENCH_BUFSIZE       4096
+
+typedef struct sid_bench_write_s {
+    CLOCK delta;
+    BYTE addr;
+    BYTE val;
+} sid_bench_write_t;
+
+typedef struct sid_bench_engine_s {
+    const char *name;
+    sid_engine_t *hooks;
+    int cycle_based;
+    int sampling;
+} sid_bench_engine_t;
+
+static const sid_bench_engine_t bench_engines[] = {
+    { "fastsid", &fastsid_hooks, 0, 0 },
+#ifdef HAVE_RESID
+    { "reSID fast", &resid_hooks, 1, 0 },
+    { "reSID interpolate", &resid_hooks, 1, 1 },
+    { "reSID resample", &resid_hooks, 1, 2 },
+    { "reSID resample fast", &resid_hooks, 1, 3 },
+#endif
+    { NULL, NULL, 0, 0 }
+};
+
+static log_t bench_log = LOG_ERR;
+
+/* Register dump given with `-sidbench'.  */
+static char *bench_file_name = NULL;
+
+static sid_bench_write_t *bench_writes = NULL;
+static unsigned int bench_writes_num = 0;
+
+static int sid_bench_load(const char *filename)
+{
+    FILE *fd;
+    char line[256];
+    unsigned int size = 0;
+    int clks, addr, val;
+
+    fd = fopen(filename, MODE_READ_TEXT);
+    if (fd == NULL) {
+        log_error(bench_log, "Cannot open `%s'.", filename);
+        return -1;
+    }
+
+    /* State dumps written on every flush are interleaved with the register
+       writes; only lines holding exactly `clks addr val' are used.  */
+    while (fgets(line, sizeof(line), fd) != NULL) {
+        if (sscanf(line, "%d %d %d", &clks, &addr, &val) != 3
+            || clks < 0 || addr < 0 || addr > 0x1f) {
+            continue;
+        }
+        if (bench_writes_num == size) {
+            size = size ? size * 2 : 1024;
+            bench_writes = lib_realloc(bench_writes,
+                                       size * sizeof(sid_bench_write_t));
+        }
+        bench_writes[bench_writes_num].delta = (CLOCK)clks;
+        bench_writes[bench_writes_num].addr = (BYTE)addr;
+        bench_writes[bench_writes_num].val = (BYTE)val;
+        bench_writes_num++;
+    }
+
+    fclose(fd);
+
+    if (bench_writes_num == 0) {
+        log_error(bench_log, "No register writes in `%s'.", filename);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Run one engine over the whole stream.  Returns the number of samples
+   generated and computes their CRC32 in `crc'.  */
+static long sid_bench_engine(const sid_bench_engine_t *engine,
+                             long cycles_per_sec, unsigned long *crc)
+{
+    BYTE sidstate[32] = { 0 };
+    SWORD *buf;
+    sound_t *psid;
+    unsigned int i;
+    long samples = 0;
+    double cycles = 0.0;
+
+    if (engine->cycle_based) {
+        resources_set_int("SidResidSampling", engine->sampling);
+    }
+
+    psid = engine->hooks->open(sidstate);
+    if (psid == NULL) {
+        return -1;
+    }
+
+    if (!engine->hooks->init(psid, SID_BENCH_SAMPLE_RATE, cycles_per_sec)) {
+        engine->hooks->close(psid);
+        return -1;
+    }
+
+    engine->hooks->reset(psid, 0);
+
+    buf = lib_malloc(SID_BENCH_BUFSIZE * sizeof(SWORD));
+    *crc = 0;
+
+    for (i = 0; i < bench_writes_num; i++) {
+        int delta_t = (int)bench_writes[i].delta;
+        int nr;
+
+        if (engine->cycle_based) {
+            while (delta_t > 0) {
+                nr = engine->hooks->calculate_samples(psid, buf,
+                                                      SID_BENCH_BUFSIZE, 1,
+                                                      &delta_t);
+                *crc = crc32_buf_update(*crc, (const char *)buf,
+                                        (unsigned int)(nr * sizeof(SWORD)));
+                samples += nr;
+            }
+        } else {
+            /* Sample based engines are asked for the number of samples
+               the elapsed cycles correspond to.  */
+            cycles += delta_t;
+            while ((nr = (int)(cycles * SID_BENCH_SAMPLE_RATE / cycles_per_sec
+                          - samples)) > 0) {
+                if (nr > SID_BENCH_BUFSIZE) {
+                    nr = SID_BENCH_BUFSIZE;
+                }
+                engine->hooks->calculate_samples(psid, buf, nr, 1, &delta_t);
+                *crc = crc32_buf_update(*crc, (const char *)buf,
+                                        (unsigned int)(nr * sizeof(SWORD)));
+                samples += nr;
+            }
+        }
+        engine->hooks->store(psid, bench_writes[i].addr, bench_writes[i].val);
+    }
+
+    lib_free(buf);
+    engine->hooks->close(psid);
+
+    return samples;
+}
+
+int sid_bench_run(const char *filename)
+{
+    const sid_bench_engine_t *engine;
+    long cycles_per_sec;
+    int sampling = 0;
+    double total_cycles = 0.0;
+    unsigned int i;
+
+    if (bench_log == LOG_ERR) {
+        bench_log = log_open("SIDBench");
+    }
+
+    if (sid_bench_load(filename) < 0) {
+        return -1;
+    }
+
+    cycles_per_sec = machine_get_cycles_per_second();
+    if (cycles_per_sec <= 0) {
+        cycles_per_sec = 985248;
+    }
+
+    for (i = 0; i < bench_writes_num; i++) {
+        total_cycles += bench_writes[i].delta;
+    }
+
+    log_message(bench_log, "%u register writes, %.0f cycles (%.1f s).",
+                bench_writes_num, total_cycles, total_cycles / cycles_per_sec);
+
+    resources_get_int("SidResidSampling", &sampling);
+
+    for (engine = bench_engines; engine->name != NULL; engine++) {
+        unsigned long start, crc;
+        double secs;
+        long samples;
+
+        start = vsyncarch_gettime();
+        samples = sid_bench_engine(engine, cycles_per_sec, &crc);
+        secs = (double)(signed long)(vsyncarch_gettime() - start)
+               / vsyncarch_frequency();
+
+        if (samples < 0) {
+            log_warning(bench_log, "%-22s cannot initialize.", engine->name);
+            continue;
+        }
+
+        if (secs <= 0.0) {
+            secs = 1.0 / vsyncarch_frequency();
+        }
+
+        log_message(bench_log,
+                    "%-22s %6.2f s, %10.0f cycles/s, %8.0f samples/s, %5.1fx realtime, crc %08lx",
+                    engine->name, secs, total_cycles / secs, samples / secs,
+                    total_cycles / cycles_per_sec / secs, crc);
+    }
+
+    resources_set_int("SidResidSampling", sampling);
+
+    lib_free(bench_writes);
+    bench_writes = NULL;
+    bench_writes_num = 0;
+
+    return 0;
+}
+
+void sid_bench_set_file(const char *filename)
+{
+    util_string_set(&bench_file_name, filename);
+}
+
+/* Run the benchmark requested with `-sidbench', if any, and exit.  */
+void sid_bench_check(void)
+{
+    int retval;
+
+    if (bench_file_name == NULL) {
+        return;
+    }
+
+    retval = sid_bench_run(bench_file_name);
+    lib_free(bench_file_name);
+    bench_file_name = NULL;
+
+    exit(retval < 0 ? 1 : 0);
+}
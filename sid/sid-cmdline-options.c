@@ -34,6 +34,7 @@
 #include "cmdline.h"
 #include "machine.h"
 #include "sid.h"
+#include "sid-bench.h"
 #include "sid-cmdline-options.h"
 #include "sid-resources.h"
 #include "translate.h"
@@ -50,6 +51,14 @@ static int sid_common_set_engine_model(const char *param, void *extra_param)
     return sid_set_engine_model(engine, model);
 }
 
+/* The benchmark runs once the machine is initialized, see
+   `sid_bench_check()'.  */
+static int sid_common_bench(const char *param, void *extra_param)
+{
+    sid_bench_set_file(param);
+    return 0;
+}
+
 static const cmdline_option_t sidcart_cmdline_options[] = {
     { "-sidenginemodel", CALL_FUNCTION, 1,
       sid_common_set_engine_model, NULL, NULL, NULL,
@@ -109,6 +118,11 @@ static const cmdline_option_t resid_cmdline_options[] = {
 #endif
 
 static const cmdline_option_t common_cmdline_options[] = {
+    { "-sidbench", CALL_FUNCTION, 1,
+      sid_common_bench, NULL, NULL, NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<name>"), T_("Benchmark the SID engines with a register dump (from -sounddev dump) and exit") },
     { "-sidstereo", SET_RESOURCE, 0,
       NULL, NULL, "SidStereo", (void *)1,
       USE_PARAM_STRING, USE_DESCRIPTION_ID,
@@ -311,6 +311,10 @@ static unsigned int cycles_per_sec;
 static unsigned int cycles_per_rfsh;
 static double rfsh_per_sec;
 
+/* Dynamic rate control may change the resampling ratio at most this much
+   from nominal, which keeps the pitch change inaudible. */
+#define SOUND_DRC_MAX_DEVIATION 0.005
+
 /* Speed in percent, tracks relative_speed from vsync.c */
 static int speed_percent;
 
@@ -368,6 +372,10 @@ typedef struct
     int prevused;
     int prevfill;
 
+    /* dynamic rate control: current ratio and smoothed fill error */
+    double drcratio;
+    double drcerror;
+
     /* is the device suspended? */
     int issuspended;
     SWORD lastsample[SOUND_CHANNELS_MAX];
@@ -653,6 +661,8 @@ int sound_open(void)
         snddata.fragnr = fragnr;
         snddata.bufsize = fragsize*fragnr;
         snddata.bufptr = 0;
+        snddata.drcratio = 1.0;
+        snddata.drcerror = 0.0;
         log_message(sound_log,
                     "Opened device `%s', speed %dHz, fragment size %dms, buffer size %dms%s",
                     pdev->name, speed,
@@ -873,6 +883,23 @@ static void prevent_clk_overflow_callback(CLOCK sub, void *data)
     }
 }
 
+/* Dynamic rate control: steer the sound buffer towards being half full by
+   a small continuous change of the rate samples are produced at. */
+static void drc_update(int fill)
+{
+    double half = snddata.bufsize / 2.0;
+    double error = (fill - half) / half;
+
+    if (error > 1.0)
+        error = 1.0;
+    if (error < -1.0)
+        error = -1.0;
+
+    /* The fill level moves in whole fragments, so smooth it out. */
+    snddata.drcerror += (error - snddata.drcerror) / 8.0;
+    snddata.drcratio = 1.0 + SOUND_DRC_MAX_DEVIATION * snddata.drcerror;
+}
+
 #ifdef __riscos
 void sound_synthesize(SWORD *buffer, int length)
 {
@@ -908,7 +935,7 @@ int sound_flush()
 double sound_flush()
 #endif
 {
-    int c, i, nr, space = 0, used;
+    int c, i, nr, space = 0, used, drc;
 
     if (!playback_enabled) {
         if (sdev_open)
@@ -957,6 +984,8 @@ double sound_flush()
     if (!nr)
         return 0;
 
+    drc = (speed_adjustment_setting == SOUND_ADJUST_DYNAMIC);
+
     /* adjust speed */
     if (snddata.playdev->bufferspace) {
         space = snddata.playdev->bufferspace();
@@ -967,6 +996,9 @@ double sound_flush()
             sound_error(translate_text(IDGS_FRAGMENT_PROBLEMS));
             return 0;
         }
+        if (drc)
+            drc_update(snddata.bufsize - space + nr);
+
         /* we only write complete fragments, sound drivers that can tell
          * better accuracy aren't utilized at this stage. */
         space -= space % snddata.fragsize;
@@ -987,8 +1019,9 @@ double sound_flush()
             }
 
             /* Calculate unused space in buffer, accounting for data we are
-             * about to write. */
-            j = snddata.bufsize - nr;
+             * about to write.  Dynamic rate control only refills up to
+             * the fill level it steers towards. */
+            j = (drc ? snddata.bufsize / 2 : snddata.bufsize) - nr;
 
             /* Fill up sound hardware buffer. */
             if (j > 0) {
@@ -1002,7 +1035,12 @@ double sound_flush()
 #endif
             vsync_sync_reset();
         }
-        if (cycle_based || speed_adjustment_setting
+        if (drc) {
+            if (speed_percent > 0)
+                snddata.clkfactor = SOUNDCLK_CONSTANT(speed_percent
+                                    * (cycle_based ? 1.0 : snddata.drcratio))
+                                    / 100;
+        } else if (cycle_based || speed_adjustment_setting
             != SOUND_ADJUST_ADJUSTING) {
             if (speed_percent > 0)
                 snddata.clkfactor = SOUNDCLK_CONSTANT(speed_percent) / 100;
@@ -1018,7 +1056,8 @@ double sound_flush()
         snddata.prevused = used;
         snddata.prevfill = 0;
 
-        if (!cycle_based && speed_adjustment_setting != SOUND_ADJUST_EXACT
+        if (!cycle_based && !drc
+            && speed_adjustment_setting != SOUND_ADJUST_EXACT
             && snddata.recdev == NULL) {
             snddata.clkfactor = SOUNDCLK_MULT(snddata.clkfactor,
                                               SOUNDCLK_CONSTANT(0.9)
@@ -1072,7 +1111,7 @@ double sound_flush()
         }
     }
 
-    if (snddata.playdev->bufferspace
+    if (snddata.playdev->bufferspace && !drc
         && (cycle_based || speed_adjustment_setting == SOUND_ADJUST_EXACT))
 #if defined(__MSDOS__) || (__riscos)
     {
@@ -1342,6 +1381,20 @@ void sound_set_warp_mode(int value)
         sound_resume();
 }
 
+/* Cycle based engines can not change their sampling rate on the fly, so
+   with dynamic rate control vsync stretches the frame length by `factor'
+   instead. */
+int sound_get_rate_control(double *factor)
+{
+    if (speed_adjustment_setting != SOUND_ADJUST_DYNAMIC || !cycle_based
+        || !sdev_open || warp_mode_enabled || snddata.playdev == NULL
+        || snddata.playdev->bufferspace == NULL)
+        return 0;
+
+    *factor = snddata.drcratio;
+    return 1;
+}
+
 void sound_snapshot_prepare(void)
 {
     /* Update lastclk.  */
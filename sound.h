@@ -106,6 +106,7 @@ static inline SWORD sound_audio_mix(int ch1, int ch2)
 #define SOUND_ADJUST_FLEXIBLE   0
 #define SOUND_ADJUST_ADJUSTING  1
 #define SOUND_ADJUST_EXACT      2
+#define SOUND_ADJUST_DYNAMIC    3
 
 /* Fragment sizes */
 #define SOUND_FRAGMENT_SMALL    0
@@ -129,6 +130,7 @@ extern void sound_set_warp_mode(int value);
 extern void sound_set_machine_parameter(long clock_rate, long ticks_per_frame);
 extern void sound_snapshot_prepare(void);
 extern void sound_snapshot_finish(void);
+extern int sound_get_rate_control(double *factor);
 
 extern int sound_resources_init(void);
 extern void sound_resources_shutdown(void);
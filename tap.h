@@ -41,6 +41,7 @@
 
 struct tape_init_s;
 struct tape_file_record_s;
+struct tap_index_s;
 
 typedef struct tap_s {
     /* File name.  */
@@ -96,6 +97,18 @@ typedef struct tap_s {
     /* Has the tap changed? We correct the size then.  */
     int has_changed;
 
+    /* Read buffer used while scanning the pulse stream, holding the file
+       contents from `read_buffer_start' on.  */
+    BYTE *read_buffer;
+    long read_buffer_start;
+    int read_buffer_len;
+
+    /* Position in the file while scanning.  */
+    long read_pos;
+
+    /* Cached index of the files on the tape, loaded on first use.  */
+    struct tap_index_s *index;
+
 } tap_t;
 
 extern void tap_init(const struct tape_init_s *init);
@@ -111,5 +124,10 @@ extern struct tape_file_record_s *tap_get_current_file_record(tap_t *tap);
 
 extern int tap_read(tap_t *tap, BYTE *buf, size_t size);
 
+extern int tap_get_cycle_counter_total(tap_t *tap, int zero_gap_delay,
+                                       int speed_tuning);
+extern void tap_set_cycle_counter_total(tap_t *tap, int cycle_counter_total,
+                                        int zero_gap_delay, int speed_tuning);
+
 #endif
 
@@ -0,0 +1,281 @@
+/*
+ * tap-index.c - Cached index of the files on a TAP image.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Finding the files on a TAP image means decoding the whole pulse stream,
+   and so does computing the length of the tape for the datasette counter.
+   The results are kept in a small text file in the user directory, named
+   after the size and modification time of the image, so a tape is only
+   scanned the first time it is used.  The CRC32 of the image is only
+   computed to check an index file that matches on size and time:
+
+     VICE TAP index 2
+     CRC <crc32>
+     COUNTER <cycles/8> <zero gap delay> <speed tuning>
+     FILES <n>
+     <seek position> <type> <encoding> <start> <end> <name as hex>
+     ...  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "archapi.h"
+#include "archdep.h"
+#include "crc32.h"
+#include "lib.h"
+#include "log.h"
+#include "tap-index.h"
+#include "tape.h"
+#include "types.h"
+#include "util.h"
+
+
+#define TAP_INDEX_MAGIC "VICE TAP index 2"
+
+#define TAP_INDEX_CRC_BUFFER_SIZE 0x4000
+
+/* A file on tape needs at least a header with the type, the addresses and
+   the name, 21 bytes with one pulse per bit, so a TAP image cannot hold
+   more than one file per this many bytes.  */
+#define TAP_INDEX_MIN_FILE_SIZE (21 * 8)
+
+static log_t tap_index_log = LOG_ERR;
+
+
+static unsigned long tap_index_crc(FILE *fd)
+{
+    char *buffer;
+    size_t len;
+    long pos;
+    unsigned long crc = 0;
+
+    buffer = lib_malloc(TAP_INDEX_CRC_BUFFER_SIZE);
+
+    pos = ftell(fd);
+    rewind(fd);
+
+    while ((len = fread(buffer, 1, TAP_INDEX_CRC_BUFFER_SIZE, fd)) > 0)
+        crc = crc32_buf_update(crc, buffer, (unsigned int)len);
+
+    fseek(fd, pos, SEEK_SET);
+
+    lib_free(buffer);
+
+    return crc;
+}
+
+static char *tap_index_file_name(tap_index_t *index)
+{
+    char *name, *path;
+
+    name = lib_msprintf("tap-%08lx-%08lx.idx", index->size, index->mtime);
+    path = archdep_pref_file_name(name);
+    lib_free(name);
+
+    return path;
+}
+
+static int tap_index_read_entry(tap_index_entry_t *entry, const char *line)
+{
+    long seek_position;
+    unsigned int type, encoding, start_addr, end_addr, c;
+    int n, i;
+
+    if (sscanf(line, "%ld %u %u %u %u %n", &seek_position, &type, &encoding,
+               &start_addr, &end_addr, &n) != 5)
+        return -1;
+
+    memset(entry, 0, sizeof(tap_index_entry_t));
+
+    entry->seek_position = seek_position;
+    entry->record.type = (BYTE)type;
+    entry->record.encoding = (BYTE)encoding;
+    entry->record.start_addr = (WORD)start_addr;
+    entry->record.end_addr = (WORD)end_addr;
+
+    for (i = 0; i < 16; i++) {
+        if (sscanf(line + n + i * 2, "%2x", &c) != 1)
+            return -1;
+        entry->record.name[i] = (BYTE)c;
+    }
+
+    return 0;
+}
+
+static void tap_index_read(tap_index_t *index, FILE *fd)
+{
+    char line[256];
+    unsigned long crc;
+    unsigned int num, i;
+
+    if (fgets(line, sizeof(line), fd) == NULL
+        || strncmp(line, TAP_INDEX_MAGIC, strlen(TAP_INDEX_MAGIC)) != 0)
+        return;
+
+    if (fgets(line, sizeof(line), fd) == NULL
+        || sscanf(line, "CRC %lx", &crc) != 1)
+        return;
+
+    /* Size and time match, make sure the contents do too.  */
+    if (!index->crc_valid) {
+        index->crc = tap_index_crc(index->fd);
+        index->crc_valid = 1;
+    }
+
+    if (crc != index->crc)
+        return;
+
+    while (fgets(line, sizeof(line), fd) != NULL) {
+        if (sscanf(line, "COUNTER %d %d %d", &index->cycle_counter_total,
+                   &index->zero_gap_delay, &index->speed_tuning) == 3)
+            continue;
+
+        if (sscanf(line, "FILES %u", &num) == 1) {
+            tap_index_clear(index);
+            if (num > index->size / TAP_INDEX_MIN_FILE_SIZE) {
+                log_warning(tap_index_log, "Invalid number of files %u.",
+                            num);
+                return;
+            }
+            index->entries = lib_calloc(num ? num : 1,
+                                        sizeof(tap_index_entry_t));
+            for (i = 0; i < num; i++) {
+                if (fgets(line, sizeof(line), fd) == NULL
+                    || tap_index_read_entry(&index->entries[i], line) < 0) {
+                    tap_index_clear(index);
+                    return;
+                }
+            }
+            index->num_entries = num;
+            index->complete = 1;
+        }
+    }
+}
+
+tap_index_t *tap_index_load(FILE *fd, const char *file_name)
+{
+    tap_index_t *index;
+    char *name;
+    FILE *index_fd;
+
+    if (tap_index_log == LOG_ERR)
+        tap_index_log = log_open("TAP Index");
+
+    index = lib_calloc(1, sizeof(tap_index_t));
+    index->fd = fd;
+    index->size = (unsigned long)util_file_length(fd);
+    if (archdep_file_mtime(file_name, &index->mtime) < 0)
+        index->mtime = 0;
+    index->cycle_counter_total = -1;
+
+    name = tap_index_file_name(index);
+    index_fd = fopen(name, MODE_READ_TEXT);
+    lib_free(name);
+
+    if (index_fd != NULL) {
+        tap_index_read(index, index_fd);
+        fclose(index_fd);
+    }
+
+    return index;
+}
+
+int tap_index_save(tap_index_t *index)
+{
+    char *name;
+    FILE *fd;
+    unsigned int i, j;
+    tap_index_entry_t *entry;
+
+    if (!index->crc_valid) {
+        index->crc = tap_index_crc(index->fd);
+        index->crc_valid = 1;
+    }
+
+    name = tap_index_file_name(index);
+    fd = fopen(name, MODE_WRITE_TEXT);
+
+    if (fd == NULL) {
+        log_warning(tap_index_log, "Cannot write `%s'.", name);
+        lib_free(name);
+        return -1;
+    }
+
+    lib_free(name);
+
+    fprintf(fd, "%s\n", TAP_INDEX_MAGIC);
+    fprintf(fd, "CRC %08lx\n", index->crc);
+
+    if (index->cycle_counter_total >= 0)
+        fprintf(fd, "COUNTER %d %d %d\n", index->cycle_counter_total,
+                index->zero_gap_delay, index->speed_tuning);
+
+    if (index->complete) {
+        fprintf(fd, "FILES %u\n", index->num_entries);
+        for (i = 0; i < index->num_entries; i++) {
+            entry = &index->entries[i];
+            fprintf(fd, "%ld %u %u %u %u ", entry->seek_position,
+                    entry->record.type, entry->record.encoding,
+                    entry->record.start_addr, entry->record.end_addr);
+            for (j = 0; j < 16; j++)
+                fprintf(fd, "%02x", entry->record.name[j]);
+            fprintf(fd, "\n");
+        }
+    }
+
+    fclose(fd);
+
+    return 0;
+}
+
+void tap_index_clear(tap_index_t *index)
+{
+    lib_free(index->entries);
+    index->entries = NULL;
+    index->num_entries = 0;
+    index->complete = 0;
+}
+
+void tap_index_destroy(tap_index_t *index)
+{
+    if (index == NULL)
+        return;
+
+    tap_index_clear(index);
+    lib_free(index);
+}
+
+void tap_index_add(tap_index_t *index, long seek_position,
+                   const tape_file_record_t *record)
+{
+    tap_index_entry_t *entry;
+
+    index->entries = lib_realloc(index->entries, (index->num_entries + 1)
+                                 * sizeof(tap_index_entry_t));
+
+    entry = &index->entries[index->num_entries++];
+    entry->seek_position = seek_position;
+    memcpy(&entry->record, record, sizeof(tape_file_record_t));
+}
@@ -0,0 +1,65 @@
+/*
+ * tap-index.h - Cached index of the files on a TAP image.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_TAP_INDEX_H
+#define VICE_TAP_INDEX_H
+
+#include <stdio.h>
+
+#include "tape.h"
+
+typedef struct tap_index_entry_s {
+    /* File position of the header, as left by `tap_seek_to_next_file()'.  */
+    long seek_position;
+    tape_file_record_t record;
+} tap_index_entry_t;
+
+typedef struct tap_index_s {
+    /* Image the index belongs to.  Size and modification time are the
+       cache key, the CRC32 is only computed once it is needed.  */
+    FILE *fd;
+    unsigned long size;
+    unsigned long mtime;
+    unsigned long crc;
+    int crc_valid;
+
+    /* Files on the tape; only valid if `complete' is set.  */
+    tap_index_entry_t *entries;
+    unsigned int num_entries;
+    int complete;
+
+    /* Datasette counter length of the tape, -1 if unknown, and the
+       datasette settings it was computed with.  */
+    int cycle_counter_total;
+    int zero_gap_delay;
+    int speed_tuning;
+} tap_index_t;
+
+extern tap_index_t *tap_index_load(FILE *fd, const char *file_name);
+extern int tap_index_save(tap_index_t *index);
+extern void tap_index_destroy(tap_index_t *index);
+extern void tap_index_clear(tap_index_t *index);
+extern void tap_index_add(tap_index_t *index, long seek_position,
+                          const tape_file_record_t *record);
+
+#endif
@@ -34,6 +34,7 @@
 #include "archdep.h"
 #include "datasette.h"
 #include "lib.h"
+#include "tap-index.h"
 #include "tap.h"
 #include "tape.h"
 #include "types.h"
@@ -61,6 +62,8 @@
 #define PILOT_TYPE_CBM 0
 #define PILOT_TYPE_TT  1
 
+#define TAP_READ_BUFFER_SIZE 0x4000
+
 /* Default values.  Call tap_init() to change. */
 static int tap_pulse_short_min    = 0x24;
 static int tap_pulse_short_max    = 0x36;
@@ -177,6 +180,8 @@ int tap_close(tap_t *tap)
     lib_free(tap->current_file_data);
     lib_free(tap->file_name);
     lib_free(tap->tap_file_record);
+    lib_free(tap->read_buffer);
+    tap_index_destroy(tap->index);
     lib_free(tap);
 
     return retval;
@@ -214,33 +219,112 @@ int tap_create(const char *name)
 }
 
 
+/* ------------------------------------------------------------------------- */
+
+/* Scanning the pulse stream reads the file through a block buffer instead
+   of doing a stdio call for every pulse.  Scanning starts with
+   `tap_buffer_begin()', which picks up the current file position, and
+   ends with `tap_buffer_end()', which moves the file position to where
+   the scan stopped.  The buffer is dropped every time, as the datasette
+   may write to the file in between.  */
+
+static void tap_buffer_begin(tap_t *tap)
+{
+    if (tap->read_buffer == NULL)
+        tap->read_buffer = lib_malloc(TAP_READ_BUFFER_SIZE);
+
+    tap->read_buffer_start = 0;
+    tap->read_buffer_len = 0;
+    tap->read_pos = ftell(tap->fd);
+}
+
+static void tap_buffer_end(tap_t *tap)
+{
+    fseek(tap->fd, tap->read_pos, SEEK_SET);
+}
+
+inline static long tap_buffer_tell(tap_t *tap)
+{
+    return tap->read_pos;
+}
+
+inline static void tap_buffer_seek(tap_t *tap, long pos)
+{
+    tap->read_pos = pos;
+}
+
+static int tap_buffer_fill(tap_t *tap)
+{
+    if (fseek(tap->fd, tap->read_pos, SEEK_SET) < 0) {
+        tap->read_buffer_len = 0;
+        return 0;
+    }
+
+    tap->read_buffer_start = tap->read_pos;
+    tap->read_buffer_len = (int)fread(tap->read_buffer, 1,
+                                      TAP_READ_BUFFER_SIZE, tap->fd);
+
+    return tap->read_buffer_len;
+}
+
+inline static int tap_buffer_getc(tap_t *tap)
+{
+    long offset;
+
+    offset = tap->read_pos - tap->read_buffer_start;
+
+    if (offset < 0 || offset >= tap->read_buffer_len) {
+        if (tap_buffer_fill(tap) <= 0)
+            return -1;
+        offset = 0;
+    }
+
+    tap->read_pos++;
+
+    return tap->read_buffer[offset];
+}
+
+/* Like fread(buf, 1, size, fd), returns the number of bytes read.  */
+static size_t tap_buffer_read(tap_t *tap, BYTE *buf, size_t size)
+{
+    size_t i;
+    int data;
+
+    for (i = 0; i < size; i++) {
+        data = tap_buffer_getc(tap);
+        if (data < 0)
+            break;
+        buf[i] = (BYTE)data;
+    }
+
+    return i;
+}
+
 /* ------------------------------------------------------------------------- */
 
 static int tap_find_pilot(tap_t *tap, int type);
 
 inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
 {
-    BYTE data;
+    int data;
     DWORD pulse_length = 0;
-    size_t res;
 
     *pos_advance = 0;
-    res = fread(&data, 1, 1, tap->fd);
+    data = tap_buffer_getc(tap);
 
-    if (res == 0)
+    if (data < 0)
         return -1;
 
-    *pos_advance += (int)res;
+    *pos_advance += 1;
 
     if (data == 0) {
         if (tap->version == 0) {
             pulse_length = 256;
         } else if ((tap->version == 1) || (tap->version == 2)) {
             BYTE size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0)
+            if (tap_buffer_read(tap, size, 3) < 3)
                 return -1;
-            *pos_advance += (int)res;
+            *pos_advance += 3;
             pulse_length = ((size[2] << 16) | (size[1] << 8) | size[0]) >> 3;
         }
     } else {
@@ -251,17 +335,16 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
     if (tap->version == 2) {
         DWORD pulse_length2;
 
-        res = fread(&data, 1, 1, tap->fd);
+        data = tap_buffer_getc(tap);
 
-        if (res == 0)
+        if (data < 0)
             return -1;
-        *pos_advance += (int)res;
+        *pos_advance += 1;
         if (data == 0) {
             BYTE size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0)
+            if (tap_buffer_read(tap, size, 3) < 3)
                 return -1;
-            *pos_advance += (int)res;
+            *pos_advance += 3;
             pulse_length2 = ((size[2] << 16) | (size[1] << 8) | size[0]) >> 3;
         } else {
             pulse_length2 = data;
@@ -362,7 +445,7 @@ static int tap_cbm_skip_pilot(tap_t *tap)
   
   errors  = 0;
   counter = 0;
-  current_filepos = ftell(tap->fd);
+  current_filepos = tap_buffer_tell(tap);
   while (1)
     {
       /*  Save file position */
@@ -373,7 +456,7 @@ static int tap_cbm_skip_pilot(tap_t *tap)
       if ( TAP_PULSE_LONG(data) )
         {
           /* found an L pulse, try to read a byte */
-          fseek(tap->fd, fpos, SEEK_SET);
+          tap_buffer_seek(tap, fpos);
           current_filepos = fpos;
           data = tap_cbm_read_byte(tap);
           if ( data==-1 ) 
@@ -387,14 +470,14 @@ static int tap_cbm_skip_pilot(tap_t *tap)
               if ( ++errors>50 ) return 0;
 
               /* Start over after the L pulse */
-              fseek(tap->fd, fpos2, SEEK_SET);
+              tap_buffer_seek(tap, fpos2);
               current_filepos = fpos2;
               counter = 0;
             }
           else
             {
               /* success.  Go back to start of byte and return */
-              fseek(tap->fd, fpos, SEEK_SET);
+              tap_buffer_seek(tap, fpos);
               current_filepos = fpos;
               return 0;
             }
@@ -724,14 +807,14 @@ static int tap_cbm_skip_file(tap_t *tap)
 
       while (1)
         {
-          fpos = ftell(tap->fd);
+          fpos = tap_buffer_tell(tap);
 
           /* find next pilot */
           ret = tap_find_pilot(tap, PILOT_TYPE_CBM);
           if ( ret<0 ) 
             {
               /* no more pilot found => end of data */
-              fseek(tap->fd, fpos, SEEK_SET);
+              tap_buffer_seek(tap, fpos);
               break;
             }
 
@@ -740,7 +823,7 @@ static int tap_cbm_skip_file(tap_t *tap)
           if ( ret<1 || buffer[0] != 2 )
             { 
               /* next block is not a data continuation block => end of data */
-              fseek(tap->fd, fpos, SEEK_SET);
+              tap_buffer_seek(tap, fpos);
               break;
             }
         }
@@ -799,7 +882,7 @@ static int tap_tt_skip_pilot(tap_t *tap)
   int data;
 
 #if TAP_DEBUG > 1
-  log_debug("\nTAP_TT_SKIP_PILOT(0x%X", ftell(tap->fd));
+  log_debug("\nTAP_TT_SKIP_PILOT(0x%X", tap_buffer_tell(tap));
 #endif
 
   /* turbo-tape pilot is just repeats of value 0x02 */
@@ -812,13 +895,13 @@ static int tap_tt_skip_pilot(tap_t *tap)
         {
           /* value != 0x02, we found the end of the pilot.  Go back
              so byte can be read again */
-          fseek(tap->fd, -8, SEEK_CUR);
+          tap_buffer_seek(tap, tap_buffer_tell(tap) - 8);
         }
     }
   while ( data==2 );
 
 #if TAP_DEBUG > 1
-  log_debug("-0x%X) ", ftell(tap->fd));
+  log_debug("-0x%X) ", tap_buffer_tell(tap));
 #endif
 
   return 0;
@@ -1016,7 +1099,7 @@ static int tap_find_pilot(tap_t *tap, int type)
        file */
     minCBM   = (type==PILOT_TYPE_ANY) ? 1000 : PILOT_MIN_LENGTH_CBM;
 
-    startCBM = ftell(tap->fd);
+    startCBM = tap_buffer_tell(tap);
     startTT  = startCBM;
     countCBM = 0;
     countTT  = 0;
@@ -1028,8 +1111,8 @@ static int tap_find_pilot(tap_t *tap, int type)
     while ( (countCBM<minCBM) && (countTT<PILOT_MIN_LENGTH_TT*8) )
       {
 /*        count = fread(&data, 1, 256, tap->fd); */
-        int startpos = ftell(tap->fd);
-        int readlen = (int)fread(buffer, 1, 256, tap->fd);
+        int startpos = tap_buffer_tell(tap);
+        int readlen = (int)tap_buffer_read(tap, buffer, 256);
 	DWORD pulse_length = 0;
 	int j = 0;
         int needed;
@@ -1049,7 +1132,7 @@ static int tap_find_pilot(tap_t *tap, int type)
                            Read some more */
                         memcpy(buffer, buffer + i + 1, readlen - (i + 1));
                         needed = 3 - (readlen - (i + 1));
-                        res = (int)fread(buffer + (readlen - (i + 1)), 1, needed, tap->fd);
+                        res = (int)tap_buffer_read(tap, buffer + (readlen - (i + 1)), needed);
                         if (res == 0) continue;
                         readlen = 3;
                         i = 0;
@@ -1067,7 +1150,7 @@ static int tap_find_pilot(tap_t *tap, int type)
                 DWORD pulse_length2;
                 /*  Read one more byte if run out of buffer */
                 if (i == readlen) {
-                    readlen = (int)fread(buffer, 1, 1, tap->fd);
+                    readlen = (int)tap_buffer_read(tap, buffer, 1);
                     if (readlen == 0) continue;
                     i = 0;
                 }
@@ -1080,7 +1163,7 @@ static int tap_find_pilot(tap_t *tap, int type)
                            Read some more */
                         memcpy(buffer, buffer + i + 1, readlen - (i + 1));
                         needed = 3 - (readlen - (i + 1));
-                        res = (int)fread(buffer + (readlen - (i + 1)), 1, needed, tap->fd);
+                        res = (int)tap_buffer_read(tap, buffer + (readlen - (i + 1)), needed);
                         if (res == 0) continue;
                         readlen = 3;
                         i = 0;
@@ -1096,14 +1179,14 @@ static int tap_find_pilot(tap_t *tap, int type)
             j++;
         }
         count = j;
-        pos[j] = ftell(tap->fd);
+        pos[j] = tap_buffer_tell(tap);
 
 /*        for (i = 0, count = 0; i < 256; i++, count++) {
-            pos[i] = ftell(tap->fd);
+            pos[i] = tap_buffer_tell(tap);
             data[i] = tap_get_pulse(tap);
             if (data[i] < 0) break;
         }
-        pos[i] = ftell(tap->fd);*/
+        pos[i] = tap_buffer_tell(tap);*/
         if (count < 1) return -1;
 
         for ( i=0; (i < count) && (countCBM < minCBM) && (countTT<PILOT_MIN_LENGTH_TT*8); i++ )
@@ -1168,12 +1251,12 @@ static int tap_find_pilot(tap_t *tap, int type)
         /* startTT points to a '1' bit which we assume to be part of the
            value 00000010.  Skip over the 1 and following 0 so we start
            at the beginning of a 00000010 sequence */
-        fseek(tap->fd, startTT+2, SEEK_SET);
+        tap_buffer_seek(tap, startTT+2);
         return 1;
       }
     else
       {
-        fseek(tap->fd, startCBM, SEEK_SET);
+        tap_buffer_seek(tap, startCBM);
         return 0;
       }
 }
@@ -1195,7 +1278,7 @@ static int tap_find_header(tap_t *tap)
         }
 
       /* store current position in TAP file */
-      fpos = ftell(tap->fd);
+      fpos = tap_buffer_tell(tap);
 
       /* try to read a header */
       if ( type==PILOT_TYPE_CBM )
@@ -1204,7 +1287,7 @@ static int tap_find_header(tap_t *tap)
           if ( res<0 ) 
             {
               int pos_advance;
-              fseek(tap->fd, fpos, SEEK_SET);
+              tap_buffer_seek(tap, fpos);
               while ( TAP_PULSE_SHORT(tap_get_pulse(tap, &pos_advance)) );
             }
         }
@@ -1213,7 +1296,7 @@ static int tap_find_header(tap_t *tap)
           res = tap_tt_read_header(tap);
           if ( res<0 ) 
             {
-              fseek(tap->fd, fpos, SEEK_SET);
+              tap_buffer_seek(tap, fpos);
               tap_tt_skip_pilot(tap);
             }
         }
@@ -1229,7 +1312,7 @@ static int tap_find_header(tap_t *tap)
             }
 
           /* success.  Rewind to start of header and return. */
-          fseek(tap->fd, fpos, SEEK_SET);
+          tap_buffer_seek(tap, fpos);
           tap->current_file_seek_position = fpos;
           return type;
         }
@@ -1247,7 +1330,7 @@ static int tap_read_file(tap_t *tap)
 #endif
 
   /* store current position in TAP file */
-  fpos = ftell(tap->fd);
+  fpos = tap_buffer_tell(tap);
 
   /* clear old file data */
   tap->current_file_size = 0;
@@ -1274,7 +1357,7 @@ static int tap_read_file(tap_t *tap)
     }
 
   /* go back to previous position in TAP file */
-  fseek(tap->fd, fpos, SEEK_SET);
+  tap_buffer_seek(tap, fpos);
 
 #if TAP_DEBUG > 0
   log_debug("\nTAP_READ_FILE(END%i)\n",ret);
@@ -1332,26 +1415,168 @@ int tap_seek_start(tap_t *tap)
   tap->current_file_number = -1;
   tap->current_file_seek_position = 0;
   fseek(tap->fd, tap->offset, SEEK_SET);
+  tap_buffer_seek(tap, tap->offset);
   return 0;
 }
 
+static int tap_seek_to_next_file_internal(tap_t *tap,
+                                          unsigned int allow_rewind);
+
+/* The index is dropped once the image has been written to, and seeking
+   falls back to scanning the tape.  */
+static tap_index_t *tap_get_index(tap_t *tap)
+{
+  if ( tap->has_changed )
+    {
+      tap_index_destroy(tap->index);
+      tap->index = NULL;
+      return NULL;
+    }
+
+  if ( tap->index==NULL )
+    tap->index = tap_index_load(tap->fd, tap->file_name);
+
+  return tap->index;
+}
+
+/* Return the index with the list of files, scanning the whole tape once
+   if the list is not known yet.  */
+static tap_index_t *tap_get_file_index(tap_t *tap)
+{
+  tap_index_t *index;
+  tape_file_record_t record;
+  long pos;
+  int file_number, seek_position;
+
+  index = tap_get_index(tap);
+  if ( index==NULL || index->complete )
+    return index;
+
+  /* remember where the tape is, the scan winds it to the end */
+  pos = ftell(tap->fd);
+  file_number = tap->current_file_number;
+  seek_position = tap->current_file_seek_position;
+  memcpy(&record, tap->tap_file_record, sizeof(tape_file_record_t));
+
+  tap_seek_start(tap);
+  tap_buffer_begin(tap);
+  while ( tap_seek_to_next_file_internal(tap, 0)>=0 )
+    tap_index_add(index, tap->current_file_seek_position,
+                  tap->tap_file_record);
+  tap_buffer_end(tap);
+
+  tap->current_file_number = file_number;
+  tap->current_file_seek_position = seek_position;
+  memcpy(tap->tap_file_record, &record, sizeof(tape_file_record_t));
+  fseek(tap->fd, pos, SEEK_SET);
+
+  index->complete = 1;
+  tap_index_save(index);
+
+  return index;
+}
+
+/* Position the tape at file `file_number' from the index, leaving the
+   same state as finding it by scanning.  */
+static void tap_index_seek(tap_t *tap, tap_index_t *index, int file_number)
+{
+  tap_index_entry_t *entry;
+
+  tap_seek_start(tap);
+  if ( file_number<0 )
+    return;
+
+  entry = &index->entries[file_number];
+  memcpy(tap->tap_file_record, &entry->record, sizeof(tape_file_record_t));
+  tap->current_file_number = file_number;
+  tap->current_file_seek_position = entry->seek_position;
+  fseek(tap->fd, entry->seek_position, SEEK_SET);
+}
+
 int tap_seek_to_file(tap_t *tap, unsigned int file_number)
 {
+  int ret = 0;
+  tap_index_t *index;
+
+  index = tap_get_file_index(tap);
+  if ( index!=NULL )
+    {
+      if ( file_number<index->num_entries )
+        {
+          tap_index_seek(tap, index, (int)file_number);
+          return 0;
+        }
+      tap_index_seek(tap, index, (int)index->num_entries - 1);
+      return -1;
+    }
+
   tap_seek_start(tap);
+  tap_buffer_begin(tap);
   while ( (int) file_number > tap->current_file_number )
     {
-      if ( tap_seek_to_next_file(tap, 0) < 0 )
-        return -1;
+      if ( tap_seek_to_next_file_internal(tap, 0) < 0 )
+        {
+          ret = -1;
+          break;
+        }
     }
+  tap_buffer_end(tap);
 
-  return 0;
+  return ret;
 }
 
 int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
 {
+  int ret;
+
+  tap_index_t *index;
+
   if (tap == NULL)
     return -1;
 
+  index = tap_get_file_index(tap);
+  if ( index!=NULL )
+    {
+      long pos = ftell(tap->fd);
+      int next;
+
+      /* clear old file content buffer */
+      tap->current_file_size = 0;
+      lib_free(tap->current_file_data);
+      tap->current_file_data = NULL;
+
+      /* Like the scan, continue from where the tape is: the next file is
+         the first one whose header is at or after the current position,
+         skipping the current file if the tape is still at its header.  */
+      for ( next=0; next<(int)index->num_entries; next++ )
+        {
+          long entry_pos = index->entries[next].seek_position;
+
+          if ( entry_pos>pos
+               || (entry_pos==pos && tap->current_file_number<0) )
+            break;
+        }
+
+      if ( next>=(int)index->num_entries )
+        {
+          if ( !allow_rewind || index->num_entries==0 )
+            return -1;
+          next = 0;
+        }
+      tap_index_seek(tap, index, next);
+      return 0;
+    }
+
+  tap_buffer_begin(tap);
+  ret = tap_seek_to_next_file_internal(tap, allow_rewind);
+  tap_buffer_end(tap);
+
+  return ret;
+}
+
+static int tap_seek_to_next_file_internal(tap_t *tap,
+                                          unsigned int allow_rewind)
+{
   /* clear old file content buffer */
   tap->current_file_size = 0;
   lib_free(tap->current_file_data);
@@ -1387,12 +1612,20 @@ int tap_read(tap_t *tap, BYTE *buf, size_t size)
         return -1; /* data==NULL and size>0 indicates read error */
       else 
         {
+          int ret = 0;
+
+          tap_buffer_begin(tap);
+
           /* if at beginning of TAP file, seek to first file */
           if ( tap->current_file_number<0 )
-            if ( tap_seek_to_next_file(tap, 0)<0 )
-              return -1;
+            ret = tap_seek_to_next_file_internal(tap, 0);
 
-          if ( tap_read_file(tap)<0 )
+          if ( ret>=0 )
+            ret = tap_read_file(tap);
+
+          tap_buffer_end(tap);
+
+          if ( ret<0 )
             return -1; /* reading the file failed */
           else
             tap->current_file_data_pos = 0;
@@ -1414,6 +1647,38 @@ int tap_read(tap_t *tap, BYTE *buf, size_t size)
 }
 
 
+/* The datasette counter length depends on the datasette settings, so it
+   is only taken from the index if they are the same.  Returns -1 if the
+   length is not known.  */
+int tap_get_cycle_counter_total(tap_t *tap, int zero_gap_delay,
+                                int speed_tuning)
+{
+  tap_index_t *index;
+
+  index = tap_get_index(tap);
+  if ( index==NULL || index->zero_gap_delay!=zero_gap_delay
+       || index->speed_tuning!=speed_tuning )
+    return -1;
+
+  return index->cycle_counter_total;
+}
+
+void tap_set_cycle_counter_total(tap_t *tap, int cycle_counter_total,
+                                 int zero_gap_delay, int speed_tuning)
+{
+  tap_index_t *index;
+
+  index = tap_get_index(tap);
+  if ( index==NULL )
+    return;
+
+  index->cycle_counter_total = cycle_counter_total;
+  index->zero_gap_delay = zero_gap_delay;
+  index->speed_tuning = speed_tuning;
+  tap_index_save(index);
+}
+
+
 void tap_get_header(tap_t *tap, BYTE *name)
 {
     memcpy(name, tap->name, 12);
@@ -50,54 +50,86 @@
 #include "vdrive.h"
 
 
+static BYTE *vdrive_bam_calculate_track(unsigned int type, BYTE *bam,
+                                        unsigned int track);
+static int vdrive_bam_isset(BYTE *bamp, unsigned int sector);
+
+/* Return the first free sector on `track' in the range `sector' up to (but
+   not including) `max_sector', or -1 if there is none.  The track bitmap
+   is looked up once and fully allocated bytes are skipped as a whole.  */
+static int vdrive_bam_find_free(unsigned int type, BYTE *bam,
+                                unsigned int track, unsigned int sector,
+                                unsigned int max_sector)
+{
+    BYTE *bamp;
+
+    bamp = vdrive_bam_calculate_track(type, bam, track);
+    if (bamp == NULL)
+        return -1;
+
+    while (sector < max_sector) {
+        if ((sector & 7) == 0 && bamp[1 + sector / 8] == 0) {
+            sector += 8;
+            continue;
+        }
+        if (vdrive_bam_isset(bamp, sector))
+            return (int)sector;
+        sector++;
+    }
+    return -1;
+}
+
+/* Allocate the first free sector on `track'.  */
+static int vdrive_bam_alloc_track(vdrive_t *vdrive, BYTE *bam,
+                                  unsigned int track, unsigned int *sector)
+{
+    int s;
+
+    s = vdrive_bam_find_free(vdrive->image_format, bam, track, 0,
+                             vdrive_get_max_sectors(vdrive->image_format,
+                                                    track));
+    if (s < 0)
+        return -1;
+
+    vdrive_bam_allocate_sector(vdrive->image_format, bam, track, s);
+    *sector = s;
+    return 0;
+}
+
 int vdrive_bam_alloc_first_free_sector(vdrive_t *vdrive, BYTE *bam,
                                        unsigned int *track,
                                        unsigned int *sector)
 {
-    unsigned int s, d, max_tracks;
+    unsigned int d, max_tracks;
     int t;
 
     max_tracks = vdrive_calculate_disk_half(vdrive->image_format);
 
     for (d = 1; d <= max_tracks; d++) {
-        int max_sector;
         t = vdrive->Bam_Track - d;
 #ifdef DEBUG_DRIVE
         log_error(LOG_ERR, "Allocate first free sector on track %d.", t);
 #endif
-        if (t >= 1) {
-            max_sector = vdrive_get_max_sectors(vdrive->image_format, t);
-            for (s = 0; s < (unsigned int)max_sector; s++) {
-                if (vdrive_bam_allocate_sector(vdrive->image_format, bam, t,
-                    s)) {
-                    *track = t;
-                    *sector = s;
+        if (t >= 1 && vdrive_bam_alloc_track(vdrive, bam, t, sector) == 0) {
+            *track = t;
 #ifdef DEBUG_DRIVE
-                    log_error(LOG_ERR,
-                              "Allocate first free sector: %d,%d.", t, s);
+            log_error(LOG_ERR, "Allocate first free sector: %d,%d.",
+                      t, *sector);
 #endif
-                    return 0;
-                }
-            }
+            return 0;
         }
         t = vdrive->Bam_Track + d;
 #ifdef DEBUG_DRIVE
         log_error(LOG_ERR, "Allocate first free sector on track %d.", t);
 #endif
-        if (t <= (int)(vdrive->num_tracks)) {
-            max_sector = vdrive_get_max_sectors(vdrive->image_format, t);
-            for (s = 0; s < (unsigned int)max_sector; s++) {
-                if (vdrive_bam_allocate_sector(vdrive->image_format, bam, t,
-                                               s)) {
-                    *track = t;
-                    *sector = s;
+        if (t <= (int)(vdrive->num_tracks)
+            && vdrive_bam_alloc_track(vdrive, bam, t, sector) == 0) {
+            *track = t;
 #ifdef DEBUG_DRIVE
-                    log_error(LOG_ERR,
-                              "Allocate first free sector: %d,%d.", t, s);
+            log_error(LOG_ERR, "Allocate first free sector: %d,%d.",
+                      t, *sector);
 #endif
-                    return 0;
-                }
-            }
+            return 0;
         }
     }
     return -1;
@@ -106,16 +138,12 @@ int vdrive_bam_alloc_first_free_sector(vdrive_t *vdrive, BYTE *bam,
 static int vdrive_bam_alloc_down(vdrive_t *vdrive, BYTE *bam,
                                  unsigned int *track, unsigned int *sector)
 {
-    unsigned int max_sector, t, s;
+    unsigned int t;
 
     for (t = *track; t >= 1; t--) {
-        max_sector = vdrive_get_max_sectors(vdrive->image_format, t);
-        for (s = 0; s < max_sector; s++) {
-            if (vdrive_bam_allocate_sector(vdrive->image_format, bam, t, s)) {
-                *track = t;
-                *sector = s;
-                return 0;
-            }
+        if (vdrive_bam_alloc_track(vdrive, bam, t, sector) == 0) {
+            *track = t;
+            return 0;
         }
     }
     return -1;
@@ -124,16 +152,12 @@ static int vdrive_bam_alloc_down(vdrive_t *vdrive, BYTE *bam,
 static int vdrive_bam_alloc_up(vdrive_t *vdrive, BYTE *bam,
                                unsigned int *track, unsigned int *sector)
 {
-    unsigned int max_sector, t, s;
+    unsigned int t;
 
     for (t = *track; t <= vdrive->num_tracks; t++) {
-        max_sector = vdrive_get_max_sectors(vdrive->image_format, t);
-        for (s = 0; s < max_sector; s++) {
-            if (vdrive_bam_allocate_sector(vdrive->image_format, bam, t, s)) {
-                *track = t;
-                *sector = s;
-                return 0;
-            }
+        if (vdrive_bam_alloc_track(vdrive, bam, t, sector) == 0) {
+            *track = t;
+            return 0;
         }
     }
     return -1;
@@ -143,7 +167,8 @@ int vdrive_bam_alloc_next_free_sector(vdrive_t *vdrive, BYTE *bam,
                                       unsigned int *track,
                                       unsigned int *sector)
 {
-    unsigned int max_sector, i, t, s;
+    unsigned int max_sector, t, s;
+    int f;
 
     if (*track == vdrive->Dir_Track)
         return -1;
@@ -158,16 +183,16 @@ int vdrive_bam_alloc_next_free_sector(vdrive_t *vdrive, BYTE *bam,
             s--;
     }
 
-    /* Look for a sector on the same track */
-    for (i = 0; i < max_sector; i++) {
-        if (vdrive_bam_allocate_sector(vdrive->image_format, bam, t, s)) {
-            *track = t;
-            *sector = s;
-            return 0;
-        }
-        s++;
-        if (s >= max_sector)
-            s = 0;
+    /* Look for a sector on the same track, from `s' on and wrapping
+       around.  */
+    f = vdrive_bam_find_free(vdrive->image_format, bam, t, s, max_sector);
+    if (f < 0)
+        f = vdrive_bam_find_free(vdrive->image_format, bam, t, 0, s);
+    if (f >= 0) {
+        vdrive_bam_allocate_sector(vdrive->image_format, bam, t, f);
+        *track = t;
+        *sector = f;
+        return 0;
     }
 
     /* Look for a sector on a close track */
@@ -51,6 +51,33 @@
 #include "vdrive.h"
 
 
+/* The directory index keeps a copy of all directory sectors together with a
+   hash of the file names, so `vdrive_dir_find_next_slot()' can search in
+   memory and only has to load the sector holding the match into
+   `Dir_buffer'.  It is rebuilt by `vdrive_dir_find_first_slot()' whenever
+   the image has been written since it was built.  */
+
+#define DIR_INDEX_HASH_SIZE     64
+#define DIR_INDEX_MAX_SECTORS   256
+
+typedef struct vdrive_dir_index_s {
+    disk_image_t *image;
+    unsigned int write_count;
+
+    /* Directory sectors in chain order.  */
+    BYTE *sectors;
+    unsigned int num_sectors;
+
+    /* Slots with the same name hash, in directory order.  */
+    int hash[DIR_INDEX_HASH_SIZE];
+    int *hash_next;
+
+    /* Non-zero while a search started by `vdrive_dir_find_first_slot()' can
+       use the index; `pos' is the sector in `Dir_buffer'.  */
+    int active;
+    unsigned int pos;
+} vdrive_dir_index_t;
+
 static log_t vdrive_dir_log = LOG_ERR;
 
 
@@ -98,6 +125,211 @@ static unsigned int vdrive_dir_name_match(BYTE *slot, BYTE *nslot, int length,
     return cbmdos_parse_wildcard_compare(nslot, &slot[SLOT_NAME_OFFSET]);
 }
 
+/* ------------------------------------------------------------------------- */
+
+/* Hash of a name up to the first shifted space, the part that
+   `cbmdos_parse_wildcard_compare()' looks at.  */
+static unsigned int vdrive_dir_index_hash(const BYTE *name)
+{
+    unsigned int i, h = 0;
+
+    for (i = 0; i < CBMDOS_SLOT_NAME_LENGTH && name[i] != 0xa0; i++)
+        h = h * 31 + name[i];
+
+    return h % DIR_INDEX_HASH_SIZE;
+}
+
+void vdrive_dir_index_free(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+
+    if (index == NULL)
+        return;
+
+    lib_free(index->sectors);
+    lib_free(index->hash_next);
+    lib_free(index);
+    vdrive->dir_index = NULL;
+}
+
+static int vdrive_dir_index_build(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index;
+    unsigned int t, s, n;
+    BYTE *slot;
+    int i, h;
+
+    index = lib_calloc(1, sizeof(vdrive_dir_index_t));
+    index->image = vdrive->image;
+    index->write_count = vdrive->image->write_count;
+
+    t = vdrive->Dir_Track;
+    s = vdrive->Dir_Sector;
+
+    for (n = 0; ; n++) {
+        /* Bad links or a looped chain are left to the sector by sector
+           search.  */
+        if (n == DIR_INDEX_MAX_SECTORS) {
+            lib_free(index->sectors);
+            lib_free(index);
+            return -1;
+        }
+        index->sectors = lib_realloc(index->sectors, (n + 1) * 256);
+        if (disk_image_read_sector(vdrive->image, index->sectors + n * 256,
+                                   t, s) != 0) {
+            lib_free(index->sectors);
+            lib_free(index);
+            return -1;
+        }
+        t = index->sectors[n * 256];
+        s = index->sectors[n * 256 + 1];
+        if (t == 0)
+            break;
+    }
+    index->num_sectors = n + 1;
+
+    index->hash_next = lib_malloc(index->num_sectors * 8 * sizeof(int));
+    for (h = 0; h < DIR_INDEX_HASH_SIZE; h++)
+        index->hash[h] = -1;
+
+    /* Insert backwards to keep the chains in directory order.  */
+    for (i = (int)index->num_sectors * 8 - 1; i >= 0; i--) {
+        slot = &index->sectors[i * 32];
+        index->hash_next[i] = -1;
+        if (!slot[SLOT_TYPE_OFFSET])
+            continue;
+        h = vdrive_dir_index_hash(&slot[SLOT_NAME_OFFSET]);
+        index->hash_next[i] = index->hash[h];
+        index->hash[h] = i;
+    }
+
+    vdrive->dir_index = index;
+
+    return 0;
+}
+
+static void vdrive_dir_index_begin(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+
+    if (index != NULL && (index->image != vdrive->image
+        || index->write_count != vdrive->image->write_count)) {
+        vdrive_dir_index_free(vdrive);
+        index = NULL;
+    }
+
+    if (index == NULL) {
+        if (vdrive_dir_index_build(vdrive) < 0)
+            return;
+        index = vdrive->dir_index;
+    }
+
+    index->active = 1;
+    index->pos = 0;
+}
+
+/* Location of directory sector `n' of the index.  */
+static void vdrive_dir_index_location(vdrive_t *vdrive, unsigned int n,
+                                      unsigned int *track,
+                                      unsigned int *sector)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+
+    if (n == 0) {
+        *track = vdrive->Dir_Track;
+        *sector = vdrive->Dir_Sector;
+    } else {
+        *track = index->sectors[(n - 1) * 256];
+        *sector = index->sectors[(n - 1) * 256 + 1];
+    }
+}
+
+/* Return non-zero if the index matches the image and the state left in
+   `vdrive' by the previous call.  */
+static int vdrive_dir_index_usable(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+    unsigned int t, s;
+
+    if (index == NULL || !index->active)
+        return 0;
+
+    if (index->image == vdrive->image
+        && index->write_count == vdrive->image->write_count) {
+        vdrive_dir_index_location(vdrive, index->pos, &t, &s);
+        if (t == vdrive->Curr_track && s == vdrive->Curr_sector)
+            return 1;
+    }
+
+    index->active = 0;
+    return 0;
+}
+
+/* Search the index from the slot after the previous match on, leaving
+   `Curr_track', `Curr_sector', `SlotNumber' and `Dir_buffer' as the sector
+   by sector search would.  Returns the slot found or NULL.  */
+static BYTE *vdrive_dir_index_find_next(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+    unsigned int from, total, n, i;
+    int found = -1, h, wildcard = 1;
+
+    total = index->num_sectors * 8;
+    from = index->pos * 8 + vdrive->SlotNumber;
+
+    if (vdrive->find_length > 0) {
+        wildcard = 0;
+        for (i = 0; i < CBMDOS_SLOT_NAME_LENGTH
+             && vdrive->find_nslot[i] != 0xa0; i++) {
+            if (vdrive->find_nslot[i] == '*' || vdrive->find_nslot[i] == '?')
+                wildcard = 1;
+        }
+    }
+
+    if (!wildcard) {
+        h = vdrive_dir_index_hash(vdrive->find_nslot);
+        for (found = index->hash[h]; found >= 0;
+             found = index->hash_next[found]) {
+            if ((unsigned int)found >= from
+                && vdrive_dir_name_match(&index->sectors[found * 32],
+                                         vdrive->find_nslot,
+                                         vdrive->find_length,
+                                         vdrive->find_type))
+                break;
+        }
+    } else {
+        for (i = from; i < total; i++) {
+            if (vdrive_dir_name_match(&index->sectors[i * 32],
+                                      vdrive->find_nslot, vdrive->find_length,
+                                      vdrive->find_type)) {
+                found = (int)i;
+                break;
+            }
+        }
+    }
+
+    /* Without a match the search ends on the last slot of the chain.  */
+    n = (found >= 0) ? (unsigned int)found / 8 : index->num_sectors - 1;
+
+    if (n != index->pos) {
+        vdrive_dir_index_location(vdrive, n, &vdrive->Curr_track,
+                                  &vdrive->Curr_sector);
+        memcpy(vdrive->Dir_buffer, &index->sectors[n * 256], 256);
+        index->pos = n;
+    }
+
+    if (found < 0) {
+        vdrive->SlotNumber = 8;
+        return NULL;
+    }
+
+    vdrive->SlotNumber = (unsigned int)found % 8;
+
+    return &vdrive->Dir_buffer[vdrive->SlotNumber * 32];
+}
+
+/* ------------------------------------------------------------------------- */
+
 void vdrive_dir_free_chain(vdrive_t *vdrive, int t, int s)
 {
     BYTE buf[256];
@@ -229,6 +461,8 @@ void vdrive_dir_find_first_slot(vdrive_t *vdrive, const char *name,
 
     disk_image_read_sector(vdrive->image, vdrive->Dir_buffer,
                            vdrive->Dir_Track, vdrive->Dir_Sector);
+
+    vdrive_dir_index_begin(vdrive);
 }
 
 BYTE *vdrive_dir_find_next_slot(vdrive_t *vdrive)
@@ -237,43 +471,59 @@ BYTE *vdrive_dir_find_next_slot(vdrive_t *vdrive)
 
     vdrive->SlotNumber++;
 
-    /*
-     * Loop all directory blocks starting from track 18, sector 1 (1541).
-     */
+    if (vdrive_dir_index_usable(vdrive)) {
+        BYTE *slot;
+
+        /* The end of the chain was already reached.  */
+        if (vdrive->SlotNumber >= 8
+            && vdrive->dir_index->pos == vdrive->dir_index->num_sectors - 1)
+            return NULL;
 
-    do {
+        slot = vdrive_dir_index_find_next(vdrive);
+        if (slot != NULL) {
+            memcpy(return_slot, slot, 32);
+            return return_slot;
+        }
+    } else {
         /*
-         * Load next(first) directory block ?
+         * Loop all directory blocks starting from track 18, sector 1 (1541).
          */
 
-        if (vdrive->SlotNumber >= 8) {
-            int status;
+        do {
+            /*
+             * Load next(first) directory block ?
+             */
 
-            if (vdrive->Dir_buffer[0] == 0)
-                return NULL;
+            if (vdrive->SlotNumber >= 8) {
+                int status;
 
-            vdrive->SlotNumber = 0;
-            vdrive->Curr_track  = (int)vdrive->Dir_buffer[0];
-            vdrive->Curr_sector = (int)vdrive->Dir_buffer[1];
+                if (vdrive->Dir_buffer[0] == 0)
+                    return NULL;
 
-            status = disk_image_read_sector(vdrive->image, vdrive->Dir_buffer,
-                                            vdrive->Curr_track,
-                                            vdrive->Curr_sector);
-            if (status != 0)
-                break;
-        }
-        while (vdrive->SlotNumber < 8) {
-            if (vdrive_dir_name_match(
+                vdrive->SlotNumber = 0;
+                vdrive->Curr_track  = (int)vdrive->Dir_buffer[0];
+                vdrive->Curr_sector = (int)vdrive->Dir_buffer[1];
+
+                status = disk_image_read_sector(vdrive->image,
+                                                vdrive->Dir_buffer,
+                                                vdrive->Curr_track,
+                                                vdrive->Curr_sector);
+                if (status != 0)
+                    break;
+            }
+            while (vdrive->SlotNumber < 8) {
+                if (vdrive_dir_name_match(
                                   &vdrive->Dir_buffer[vdrive->SlotNumber * 32],
                                   vdrive->find_nslot, vdrive->find_length,
                                   vdrive->find_type)) {
-                memcpy(return_slot,
-                       &vdrive->Dir_buffer[vdrive->SlotNumber * 32], 32);
-                return return_slot;
+                    memcpy(return_slot,
+                           &vdrive->Dir_buffer[vdrive->SlotNumber * 32], 32);
+                    return return_slot;
+                }
+                vdrive->SlotNumber++;
             }
-            vdrive->SlotNumber++;
-        }
-    } while (*(vdrive->Dir_buffer));
+        } while (*(vdrive->Dir_buffer));
+    }
 
     /*
      * If length < 0, create new directory-entry if possible
@@ -55,6 +55,7 @@ struct vdrive_s;
 struct bufferinfo_s;
 
 extern void vdrive_dir_init(void);
+extern void vdrive_dir_index_free(struct vdrive_s *vdrive);
 extern int vdrive_dir_create_directory(struct vdrive_s *vdrive,
                                        const char *name,
                                        int length, int filetype,
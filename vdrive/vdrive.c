@@ -106,6 +106,7 @@ void vdrive_device_shutdown(vdrive_t *vdrive)
     if (vdrive != NULL) {
         for (i = 0; i < 16; i++)
             lib_free(vdrive->buffers[i].buffer);
+        vdrive_dir_index_free(vdrive);
     }
 }
 
@@ -194,6 +195,7 @@ void vdrive_detach_image(disk_image_t *image, unsigned int unit,
 
     disk_image_detach_log(image, vdrive_log, unit);
     vdrive_close_all_channels(vdrive);
+    vdrive_dir_index_free(vdrive);
     vdrive->image = NULL;
 }
 
@@ -244,6 +246,7 @@ int vdrive_attach_image(disk_image_t *image, unsigned int unit,
     /* Initialise format constants */
     vdrive_set_disk_geometry(vdrive);
 
+    vdrive_dir_index_free(vdrive);
     vdrive->image = image;
 
     if (vdrive_bam_read_bam(vdrive)) {
@@ -138,6 +138,9 @@ typedef struct vdrive_s {
     BYTE find_nslot[16];
     unsigned int find_type;
 
+    /* In-memory copy of the directory, see vdrive-dir.c.  */
+    struct vdrive_dir_index_s *dir_index;
+
     unsigned int Curr_track;
     unsigned int Curr_sector;
 
@@ -52,12 +52,14 @@ int vsync_frame_counter;
 #include <limits.h>
 #endif
 
+#include "batchjob.h"
 #include "clkguard.h"
 #include "cmdline.h"
 #include "debug.h"
 #include "log.h"
 #include "maincpu.h"
 #include "machine.h"
+#include "monitor.h"
 #ifdef HAVE_NETWORK
 #include "monitor_network.h"
 #endif
@@ -309,6 +311,7 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
     static signed long avg_sdelay, prev_sdelay;
 
     double sound_delay;
+    double drc_factor;
     int skip_next_frame;
 
     signed long delay;
@@ -324,6 +327,12 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
     monitor_check_remote();
 #endif
 
+#ifdef FEATURE_CPUMEMHISTORY
+    monitor_memmap_frame();
+#endif
+
+    batchjob_frame();
+
     vsync_frame_counter++;
 
     /*
@@ -492,13 +501,19 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
     }
 
     /* Adjust frame output frequency to match sound speed.
-       This only kicks in for cycle based sound and SOUND_ADJUST_EXACT. */
+       This only kicks in for cycle based sound with SOUND_ADJUST_EXACT,
+       which averages the sound delay, or SOUND_ADJUST_DYNAMIC, which
+       scales the frame length by the rate control factor every frame. */
     if (frames_adjust < INT_MAX) {
         frames_adjust++;
     }
 
     /* Adjust audio-video sync */
-    if (!network_connected()
+    if (!network_connected() && sound_get_rate_control(&drc_factor)) {
+        /* Dynamic rate control: follow the sound buffer fill level with a
+           small continuous change of the frame length. */
+        frame_ticks = (long)(frame_ticks_orig * drc_factor);
+    } else if (!network_connected()
         && (signed long)(now - adjust_start) >= vsyncarch_freq / 5) {
         signed long adjust;
         avg_sdelay /= frames_adjust;
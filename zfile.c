@@ -44,15 +44,23 @@
 #ifdef HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef HAVE_MINIZIP
+#include "libmz/unzip.h"
+#endif
 
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
 #endif
 
+#include "archapi.h"
 #include "archdep.h"
+#include "cmdline.h"
+#include "crc32.h"
 #include "ioutil.h"
 #include "lib.h"
 #include "log.h"
+#include "resources.h"
+#include "translate.h"
 #include "util.h"
 #include "zfile.h"
 #include "zipcode.h"
@@ -159,9 +167,12 @@ static void zfile_list_add(const char *tmp_name,
     zfile_list = new_zfile;
 }
 
+static void zfile_cache_free(void);
+
 void zfile_shutdown(void)
 {
     zfile_list_destroy();
+    zfile_cache_free();
 }
 
 /* ------------------------------------------------------------------------ */
@@ -516,6 +527,105 @@ static char *try_uncompress_archive(const char *name, int write_mode,
 #endif
 }
 
+#ifdef HAVE_MINIZIP
+/* Append the current file of `zip' to `fddest'.  */
+static int extract_with_minizip(unzFile zip, FILE *fddest)
+{
+    char buf[4096];
+    int len;
+
+    if (unzOpenCurrentFile(zip) != UNZ_OK)
+        return -1;
+
+    do {
+        len = unzReadCurrentFile(zip, buf, sizeof(buf));
+        if (len > 0 && fwrite(buf, 1, (size_t)len, fddest) != (size_t)len)
+            len = -1;
+    } while (len > 0);
+
+    if (unzCloseCurrentFile(zip) != UNZ_OK)
+        len = -1;
+
+    return len;
+}
+
+/* If `name' has a `.zip' extension, extract the first file with a proper
+   extension in-process, the same way `try_uncompress_archive()' does with
+   unzip.  */
+static char *try_uncompress_with_minizip(const char *name, int write_mode)
+{
+    unzFile zip;
+    unz_file_info info;
+    FILE *fddest;
+    char *tmp_name = NULL;
+    char tmp[1024];
+    size_t l = strlen(name);
+    int found = 0, i, retval;
+
+    if (l <= 4 || strcasecmp(name + l - 4, ".zip") != 0)
+        return NULL;
+
+    zip = unzOpen(name);
+    if (zip == NULL)
+        return NULL;
+
+    retval = unzGoToFirstFile(zip);
+    while (retval == UNZ_OK) {
+        if (unzGetCurrentFileInfo(zip, &info, tmp, sizeof(tmp),
+                                  NULL, 0, NULL, 0) != UNZ_OK)
+            break;
+        if (is_valid_extension(tmp, strlen(tmp), 0)) {
+            ZDEBUG(("try_uncompress_with_minizip: found `%s'.", tmp));
+            found = 1;
+            break;
+        }
+        retval = unzGoToNextFile(zip);
+    }
+
+    if (!found) {
+        unzClose(zip);
+        return NULL;
+    }
+
+    if (write_mode) {
+        ZDEBUG(("try_uncompress_with_minizip: cannot open file in write mode."));
+        unzClose(zip);
+        return "";
+    }
+
+    fddest = archdep_mkstemp_fd(&tmp_name, MODE_WRITE);
+    if (fddest == NULL) {
+        unzClose(zip);
+        return NULL;
+    }
+
+    /* A zipcode set is extracted as its four parts in a row.  */
+    if (is_zipcode_name(tmp)) {
+        for (i = 0; i < 4 && retval >= 0; i++) {
+            tmp[0] = '1' + i;
+            if (unzLocateFile(zip, tmp, 0) != UNZ_OK)
+                retval = -1;
+            else
+                retval = extract_with_minizip(zip, fddest);
+        }
+    } else {
+        retval = extract_with_minizip(zip, fddest);
+    }
+
+    unzClose(zip);
+    fclose(fddest);
+
+    if (retval < 0) {
+        ZDEBUG(("try_uncompress_with_minizip: extracting `%s' failed.", tmp));
+        ioutil_remove(tmp_name);
+        lib_free(tmp_name);
+        return NULL;
+    }
+
+    return tmp_name;
+}
+#endif
+
 #ifdef __riscos
 #define C1541_NAME     "Vice:c1541"
 #else
@@ -727,6 +837,11 @@ static enum compression_type try_uncompress(const char *name,
 {
     int i;
 
+#ifdef HAVE_MINIZIP
+    if ((*tmp_name = try_uncompress_with_minizip(name, write_mode)) != NULL)
+        return COMPR_ARCHIVE;
+#endif
+
     for (i = 0; valid_archives[i].program; i++) {
         if ((*tmp_name = try_uncompress_archive(name, write_mode,
                         valid_archives[i].program,
@@ -760,6 +875,338 @@ static enum compression_type try_uncompress(const char *name,
 
 /* ------------------------------------------------------------------------- */
 
+/* Decompression cache.
+
+   With `ZFileCache' enabled, decompressed files opened for reading are
+   kept in the user directory, named after the CRC32 and size of the
+   compressed file, so opening the same archive again only costs a
+   checksum of the original.  Since the key depends on the contents only,
+   an entry never goes stale.  The index file lists the entries, least
+   recently used first; the oldest ones are removed when the cache would
+   grow beyond `ZFileCacheSize' KB.  */
+
+#define ZFILE_CACHE_BUFFER_SIZE 0x4000
+#define ZFILE_CACHE_INDEX_NAME  "zcache.idx"
+
+struct zfile_cache_entry_s {
+    char *name;                         /* File name in the user dir.  */
+    unsigned long size;                 /* Size of the file.  */
+    struct zfile_cache_entry_s *next;
+};
+typedef struct zfile_cache_entry_s zfile_cache_entry_t;
+
+static int zfile_cache_enabled = 0;
+static int zfile_cache_size_kb = 16384;
+
+static zfile_cache_entry_t *zfile_cache_entries = NULL;
+static int zfile_cache_loaded = 0;
+
+static int set_zfile_cache_enabled(int val, void *param)
+{
+    zfile_cache_enabled = val ? 1 : 0;
+
+    return 0;
+}
+
+static int set_zfile_cache_size(int val, void *param)
+{
+    if (val < 0)
+        return -1;
+
+    zfile_cache_size_kb = val;
+
+    return 0;
+}
+
+static const resource_int_t resources_int[] = {
+    { "ZFileCache", 0, RES_EVENT_NO, NULL,
+      &zfile_cache_enabled, set_zfile_cache_enabled, NULL },
+    { "ZFileCacheSize", 16384, RES_EVENT_NO, NULL,
+      &zfile_cache_size_kb, set_zfile_cache_size, NULL },
+    { NULL }
+};
+
+int zfile_resources_init(void)
+{
+    return resources_register_int(resources_int);
+}
+
+static const cmdline_option_t cmdline_options[] = {
+    { "-zfilecache", SET_RESOURCE, 0,
+      NULL, NULL, "ZFileCache", (resource_value_t)1,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      NULL, T_("Keep decompressed archives in a cache in the user directory") },
+    { "+zfilecache", SET_RESOURCE, 0,
+      NULL, NULL, "ZFileCache", (resource_value_t)0,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      NULL, T_("Decompress archives every time they are opened") },
+    { "-zfilecachesize", SET_RESOURCE, 1,
+      NULL, NULL, "ZFileCacheSize", NULL,
+      USE_PARAM_STRING, USE_DESCRIPTION_STRING,
+      IDCLS_UNUSED, IDCLS_UNUSED,
+      T_("<KB>"), T_("Maximum size of the decompression cache (default 16384)") },
+    { NULL }
+};
+
+int zfile_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+static void zfile_cache_free(void)
+{
+    zfile_cache_entry_t *entry;
+
+    while (zfile_cache_entries != NULL) {
+        entry = zfile_cache_entries;
+        zfile_cache_entries = entry->next;
+        lib_free(entry->name);
+        lib_free(entry);
+    }
+
+    zfile_cache_loaded = 0;
+}
+
+static void zfile_cache_append(char *name, unsigned long size)
+{
+    zfile_cache_entry_t *entry, **last;
+
+    entry = lib_malloc(sizeof(zfile_cache_entry_t));
+    entry->name = name;
+    entry->size = size;
+    entry->next = NULL;
+
+    for (last = &zfile_cache_entries; *last != NULL; last = &(*last)->next)
+        ;
+    *last = entry;
+}
+
+/* Remove the entry `name' from the list and return it, or NULL.  */
+static zfile_cache_entry_t *zfile_cache_unlink(const char *name)
+{
+    zfile_cache_entry_t *entry, **prev;
+
+    for (prev = &zfile_cache_entries; *prev != NULL; prev = &(*prev)->next) {
+        entry = *prev;
+        if (strcmp(entry->name, name) == 0) {
+            *prev = entry->next;
+            entry->next = NULL;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void zfile_cache_load_index(void)
+{
+    char *path;
+    FILE *fd;
+    char line[256];
+    char *sep;
+
+    if (zfile_cache_loaded)
+        return;
+
+    zfile_cache_loaded = 1;
+
+    path = archdep_pref_file_name(ZFILE_CACHE_INDEX_NAME);
+    fd = fopen(path, MODE_READ_TEXT);
+    lib_free(path);
+
+    if (fd == NULL)
+        return;
+
+    /* One `<name> <size>' line per entry.  */
+    while (util_get_line(line, sizeof(line), fd) >= 0) {
+        sep = strchr(line, ' ');
+        if (sep == NULL)
+            continue;
+        *sep++ = '\0';
+        zfile_cache_append(lib_stralloc(line), strtoul(sep, NULL, 10));
+    }
+
+    fclose(fd);
+}
+
+static void zfile_cache_save_index(void)
+{
+    char *path;
+    FILE *fd;
+    zfile_cache_entry_t *entry;
+
+    path = archdep_pref_file_name(ZFILE_CACHE_INDEX_NAME);
+    fd = fopen(path, MODE_WRITE_TEXT);
+
+    if (fd == NULL) {
+        log_warning(zlog, "Cannot write `%s'.", path);
+        lib_free(path);
+        return;
+    }
+
+    lib_free(path);
+
+    for (entry = zfile_cache_entries; entry != NULL; entry = entry->next)
+        fprintf(fd, "%s %lu\n", entry->name, entry->size);
+
+    fclose(fd);
+}
+
+/* Remove the least recently used entries until `size' more bytes fit.
+   Entries that cannot be removed (e.g. because they are open) stay.  */
+static void zfile_cache_evict(unsigned long size)
+{
+    zfile_cache_entry_t *entry, **prev;
+    unsigned long total = 0, limit;
+    char *path;
+
+    limit = (unsigned long)zfile_cache_size_kb * 1024;
+
+    for (entry = zfile_cache_entries; entry != NULL; entry = entry->next)
+        total += entry->size;
+
+    prev = &zfile_cache_entries;
+    while (*prev != NULL && total + size > limit) {
+        entry = *prev;
+        path = archdep_pref_file_name(entry->name);
+        if (ioutil_remove(path) == 0 || ioutil_access(path, IOUTIL_ACCESS_F_OK) < 0) {
+            ZDEBUG(("zfile_cache_evict: removed `%s'.", entry->name));
+            total -= entry->size;
+            *prev = entry->next;
+            lib_free(entry->name);
+            lib_free(entry);
+        } else {
+            prev = &entry->next;
+        }
+        lib_free(path);
+    }
+}
+
+/* Return non-zero if `name' looks like something `try_uncompress()' could
+   handle; this keeps plain files from being checksummed.  */
+static int zfile_cache_candidate(const char *name)
+{
+    static const char *cache_extensions[] = {
+        ".bz2", ".tzx", ".zip", ".lzh", ".lha", ".tar", ".tgz", ".zoo",
+        ".lnx", NULL
+    };
+    char *fname = NULL;
+    size_t l = strlen(name), len;
+    int i, zipcode;
+
+    if (archdep_file_is_gzip(name))
+        return 1;
+
+    for (i = 0; cache_extensions[i] != NULL; i++) {
+        len = strlen(cache_extensions[i]);
+        if (l > len && strcasecmp(name + l - len, cache_extensions[i]) == 0)
+            return 1;
+    }
+
+    util_fname_split(name, NULL, &fname);
+    if (fname == NULL)
+        return 0;
+    zipcode = (strlen(fname) >= 3 && fname[1] == '!');
+    lib_free(fname);
+
+    return zipcode;
+}
+
+/* Return the name of the cache entry for `name', or NULL if `name' should
+   not be cached.  */
+static char *zfile_cache_key(const char *name)
+{
+    FILE *fd;
+    char *buffer;
+    size_t len;
+    unsigned long crc = 0, size = 0;
+
+    if (!zfile_cache_enabled || zfile_cache_size_kb == 0
+        || !zfile_cache_candidate(name))
+        return NULL;
+
+    fd = fopen(name, MODE_READ);
+    if (fd == NULL)
+        return NULL;
+
+    buffer = lib_malloc(ZFILE_CACHE_BUFFER_SIZE);
+
+    while ((len = fread(buffer, 1, ZFILE_CACHE_BUFFER_SIZE, fd)) > 0) {
+        crc = crc32_buf_update(crc, buffer, (unsigned int)len);
+        size += (unsigned long)len;
+    }
+
+    lib_free(buffer);
+    fclose(fd);
+
+    return lib_msprintf("zcache-%08lx-%lx.bin", crc, size);
+}
+
+/* Open the cache entry `key', making it the most recently used one.  */
+static FILE *zfile_cache_open(const char *key, const char *mode)
+{
+    zfile_cache_entry_t *entry;
+    char *path;
+    FILE *stream;
+
+    zfile_cache_load_index();
+
+    entry = zfile_cache_unlink(key);
+    if (entry == NULL)
+        return NULL;
+
+    path = archdep_pref_file_name(key);
+    stream = fopen(path, mode);
+    lib_free(path);
+
+    if (stream == NULL) {
+        lib_free(entry->name);
+        lib_free(entry);
+    } else {
+        zfile_cache_append(entry->name, entry->size);
+        lib_free(entry);
+    }
+
+    zfile_cache_save_index();
+
+    return stream;
+}
+
+/* Move the decompressed file `tmp_name' into the cache as `key' and open
+   it.  Returns NULL if it does not fit or cannot be moved.  */
+static FILE *zfile_cache_add(const char *key, const char *tmp_name,
+                             const char *mode)
+{
+    unsigned int len, isdir;
+    char *path;
+    FILE *stream;
+
+    if (ioutil_stat(tmp_name, &len, &isdir) < 0
+        || (unsigned long)len > (unsigned long)zfile_cache_size_kb * 1024)
+        return NULL;
+
+    zfile_cache_load_index();
+    zfile_cache_evict((unsigned long)len);
+
+    path = archdep_pref_file_name(key);
+    if (ioutil_rename(tmp_name, path) < 0) {
+        lib_free(path);
+        return NULL;
+    }
+
+    stream = fopen(path, mode);
+    lib_free(path);
+
+    zfile_cache_append(lib_stralloc(key), (unsigned long)len);
+    zfile_cache_save_index();
+
+    return stream;
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* Compression.  */
 
 /* Compress `src' into `dest' using gzip.  */
@@ -977,7 +1424,7 @@ static int zfile_compress(const char *src, const char *dest,
 /* `fopen()' wrapper.  */
 FILE *zfile_fopen(const char *name, const char *mode)
 {
-    char *tmp_name;
+    char *tmp_name, *cache_key;
     FILE *stream;
     enum compression_type type;
     int write_mode = 0;
@@ -996,18 +1443,48 @@ FILE *zfile_fopen(const char *name, const char *mode)
     if (write_mode && ioutil_access(name, IOUTIL_ACCESS_W_OK) < 0)
         return NULL;
 
+    /* Files opened for writing must be recompressed on close, so they are
+       never taken from the cache.  */
+    cache_key = write_mode ? NULL : zfile_cache_key(name);
+    if (cache_key != NULL) {
+        stream = zfile_cache_open(cache_key, mode);
+        if (stream != NULL) {
+            ZDEBUG(("zfile_fopen: using cached `%s'.", cache_key));
+            zfile_list_add(NULL, name, COMPR_NONE, write_mode, stream, NULL);
+            lib_free(cache_key);
+            return stream;
+        }
+    }
+
     type = try_uncompress(name, &tmp_name, write_mode);
     if (type == COMPR_NONE) {
+        lib_free(cache_key);
         stream = fopen(name, mode);
         if (stream == NULL)
             return NULL;
         zfile_list_add(NULL, name, type, write_mode, stream, NULL);
         return stream;
     } else if (*tmp_name == '\0') {
+        lib_free(cache_key);
         errno = EACCES;
         return NULL;
     }
 
+    /* Move the uncompressed file into the cache; it is then opened like a
+       plain file and kept on close.  If it does not fit, it stays a
+       temporary file.  */
+    if (cache_key != NULL) {
+        stream = zfile_cache_add(cache_key, tmp_name, mode);
+        if (stream != NULL) {
+            lib_free(cache_key);
+            lib_free(tmp_name);
+            zfile_list_add(NULL, name, type, write_mode, stream, NULL);
+            return stream;
+        }
+    }
+
+    lib_free(cache_key);
+
     /* Open the uncompressed version of the file.  */
     stream = fopen(tmp_name, mode);
     if (stream == NULL)
@@ -41,6 +41,8 @@ extern FILE *zfile_fopen(const char *name, const char *mode);
 extern int zfile_fclose(FILE *stream);
 
 extern void zfile_shutdown(void);
+extern int zfile_resources_init(void);
+extern int zfile_cmdline_options_init(void);
 
 extern int zfile_close_action(const char *filename, zfile_action_t action,
                               const char *request_string);